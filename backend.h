@@ -0,0 +1,131 @@
+/* =============================================================================
+// BORDERless: window system backend
+//
+// Private: shared by the library, the app and the benchmarks.
+//
+// Neither the core logic (`libborderless.c`) nor the configuration file
+// code (`config.c`) calls the operating system on its own: everything
+// goes through the table below. `backend_win32.c` implements it with
+// WinAPI, `backend_xcb.c` with X11, and `bench/fake.c` with an in-memory
+// window table, so that the logic can be measured and tested away from
+// a desktop.
+// Events and timers come back through the `core_*()` functions.
+// -------------------------------------------------------------------------- */
+
+#ifndef BORDERLESS_BACKEND_H
+#define BORDERLESS_BACKEND_H
+
+#include "libborderless.h"
+
+/* What happened to a window */
+enum core_event {
+  CORE_EVENT_CREATE,
+  CORE_EVENT_DESTROY,
+  CORE_EVENT_SHOW,
+  CORE_EVENT_HIDE,
+  CORE_EVENT_NAMECHANGE,
+  CORE_EVENT_LOCATION
+};
+
+/* Event sources, switched on only while needed */
+enum core_watch {
+  CORE_WATCH_WINDOWS,  // all but location changes, of any window
+  CORE_WATCH_LOCATION  // location changes of windows of other processes
+};
+
+typedef bool backend_enum_fn (HWND wnd, void* param);
+
+struct backend {
+  /* Lifetime, see `borderless_init()` */
+  bool  (*open)  (void);
+  void  (*close) (void);
+  DWORD (*current_thread) (void);
+  /* Timers and event sources: see `core_timer()` and `core_event()` */
+  bool  (*set_timer)  (UINT id, UINT ms);
+  void  (*kill_timer) (UINT id);
+  bool  (*watch)      (enum core_watch what, bool on);
+  /* Windows */
+  LONG  (*get_style)    (HWND wnd, int index);
+  LONG  (*set_style)    (HWND wnd, int index, LONG style);
+  HMENU (*get_menu)     (HWND wnd);
+  bool  (*set_menu)     (HWND wnd, HMENU menu);
+  bool  (*enum_windows) (backend_enum_fn* fn, void* param);
+  DWORD (*get_thread)   (HWND wnd); // 0 if no such window
+  DWORD (*get_process)  (HWND wnd);
+  int   (*get_class)    (HWND wnd, wchar_t* cls, int size);
+  int   (*get_title)    (HWND wnd, wchar_t* title, int size);
+  bool  (*get_exe)      (DWORD pid, wchar_t* path, size_t size);
+  bool  (*is_top_level) (HWND wnd);
+  bool  (*is_visible)   (HWND wnd);
+  bool  (*is_minimized) (HWND wnd);
+  bool  (*is_maximized) (HWND wnd);
+  bool  (*get_rect)     (HWND wnd, RECT* rect);
+  UINT  (*get_dpi)      (HWND wnd); // 0 if unknown
+  void  (*repaint)      (HWND wnd);
+  void  (*frame_changed)(HWND wnd);
+  /* Ways of hiding borders other than styles */
+  bool  (*dwm_border)   (HWND wnd, bool hide);
+  bool  (*clip_client)  (HWND wnd); // clip the window to its client area
+  void* (*get_region)   (HWND wnd); // copy of its own region, NULL if none
+  void  (*unclip)       (HWND wnd, void* region); // takes `region`, NULL for none
+  void  (*free_region)  (void* region);
+  /* Hook module: NULL if it couldn't be attached */
+  void* (*veto_attach)  (HWND wnd, DWORD thread, LONG mask, LONG mask_ex);
+  long  (*veto_detach)  (void* veto); // how many times the frame was kept away
+  /* Placement. Deferred positions all take effect at once,
+  // a failed batch is gone and returns NULL. */
+  HDWP  (*defer_begin)  (int num);
+  HDWP  (*defer_pos)    (HDWP dwp, HWND wnd, const RECT* rect, UINT flags);
+  bool  (*defer_end)    (HDWP dwp);
+  bool  (*set_pos)      (HWND wnd, const RECT* rect, UINT flags);
+  bool  (*show)         (HWND wnd, int cmd);
+  /* Restored position in screen coordinates, and whether maximized.
+  // Setting it doesn't activate the window. */
+  bool  (*get_placement) (HWND wnd, RECT* rect, bool* maximized);
+  bool  (*set_placement) (HWND wnd, const RECT* rect, bool maximized);
+  /* Monitor rectangles. Returns how many there are. */
+  size_t (*get_monitors) (RECT* rects, size_t max);
+  /* Hotkeys */
+  bool  (*register_hotkey)   (HWND wnd, int id, UINT mod, UINT code);
+  bool  (*unregister_hotkey) (HWND wnd, int id);
+  /* UTF-16 text files. What is read must be freed. */
+  wchar_t* (*file_read) (const wchar_t* path);
+  bool  (*file_write)   (const wchar_t* path, const wchar_t* text); // flushed to disk
+  bool  (*file_replace) (const wchar_t* src, const wchar_t* dst);
+  void  (*file_remove)  (const wchar_t* path);
+};
+
+/* Backend in use, see `borderless_set_backend()` */
+extern const struct backend* backend;
+
+#ifdef _WIN32
+extern const struct backend backend_win32;
+#else
+/* File functions for POSIX systems, see `backend_posix.c` */
+wchar_t* posix_file_read (const wchar_t* path);
+bool posix_file_write (const wchar_t* path, const wchar_t* text);
+bool posix_file_replace (const wchar_t* src, const wchar_t* dst);
+void posix_file_remove (const wchar_t* path);
+#endif
+
+#ifdef BORDERLESS_XCB
+extern const struct backend backend_xcb;
+/* Waits up to `ms` (-1 for as long as it takes) for X events and
+// timers and handles them. `hotkey` gets the id of every hotkey
+// pressed. False once the connection is gone. */
+bool backend_xcb_wait (int ms, void (*hotkey) (int id));
+/* The window which has the focus, NULL if none */
+HWND backend_xcb_active (void);
+#endif
+
+/* Called by the backend on the thread which called `borderless_init()` */
+void core_event (enum core_event event, HWND wnd);
+void core_timer (UINT id);
+void core_display_changed (void);
+
+/* Compares the window inventory against a fresh enumeration */
+bool core_inventory_check (void);
+/* Whether a compatibility rule, user or built-in, matches the window */
+bool core_compat_match (HWND wnd);
+
+#endif
@@ -0,0 +1,113 @@
+/* =============================================================================
+// BORDERless: backend parts shared by POSIX systems
+//
+// UTF-16LE text files with a byte order mark and CRLF line breaks,
+// the same files the WinAPI backend reads and writes. Paths are
+// converted to the multibyte encoding of the current locale.
+// -------------------------------------------------------------------------- */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <wchar.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+
+/* -----------------------------------------------------------------------------
+// Files */
+
+static bool to_mb (const wchar_t* const path, char* const out, size_t const size)
+{
+  const size_t len = wcstombs (out, path, size);
+  return len != (size_t)-1 && len < size;
+}
+
+wchar_t* posix_file_read (const wchar_t* const path)
+{
+  char mb[1024];
+  if (!to_mb (path, mb, sizeof(mb))) return NULL;
+  const int fd = open (mb, O_RDONLY);
+  if (fd == -1) return NULL;
+  const off_t size = lseek (fd, 0, SEEK_END);
+  lseek (fd, 0, SEEK_SET);
+  unsigned char* const bytes = size > 0 && !(size & 1) ? malloc (size) : NULL;
+  wchar_t* text = bytes != NULL ? arrnew (wchar_t, size / 2 + 1) : NULL;
+  bool ok = text != NULL;
+  for (off_t got = 0; ok && got != size;) {
+    const ssize_t n = read (fd, bytes + got, size - got);
+    ok = n > 0;
+    got += ok ? n : 0;
+  }
+  close (fd);
+  if (size == 0) {
+    free (text);
+    text = calloc (1, sizeof(wchar_t));
+    ok = text != NULL;
+  } else if (ok) {
+    /* Byte order mark is for the C runtime to strip */
+    size_t i = size >= 2 && bytes[0] == 0xff && bytes[1] == 0xfe ? 2 : 0;
+    size_t len = 0;
+    for (; i < (size_t)size; i += 2) text[len++] = bytes[i] | (bytes[i + 1] << 8);
+    text[len] = '\0';
+  }
+  free (bytes);
+  if (!ok) {
+    free (text);
+    return NULL;
+  }
+  return text;
+}
+
+/* UTF-16LE with a byte order mark and CRLF line breaks */
+bool posix_file_write (const wchar_t* const path, const wchar_t* const text)
+{
+  char mb[1024];
+  if (!to_mb (path, mb, sizeof(mb))) return false;
+  const size_t len = wcslen (text);
+  unsigned char* const bytes = malloc (2 + len * 4);
+  if (bytes == NULL) return false;
+  size_t n = 0;
+  bytes[n++] = 0xff;
+  bytes[n++] = 0xfe;
+  for (size_t i = 0; i != len; ++i) {
+    if (text[i] == '\n') {
+      bytes[n++] = '\r';
+      bytes[n++] = 0;
+    }
+    bytes[n++] = text[i] & 0xff;
+    bytes[n++] = (text[i] >> 8) & 0xff;
+  }
+  const int fd = open (mb, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  bool ok = fd != -1;
+  for (size_t done = 0; ok && done != n;) {
+    const ssize_t w = write (fd, bytes + done, n - done);
+    ok = w > 0;
+    done += ok ? w : 0;
+  }
+  free (bytes);
+  if (fd == -1) return false;
+  ok = fsync (fd) == 0 && ok;
+  return close (fd) == 0 && ok;
+}
+
+bool posix_file_replace (const wchar_t* const src, const wchar_t* const dst)
+{
+  char mb_src[1024], mb_dst[1024];
+  if (!to_mb (src, mb_src, sizeof(mb_src)) || !to_mb (dst, mb_dst, sizeof(mb_dst))) return false;
+  return rename (mb_src, mb_dst) == 0;
+}
+
+void posix_file_remove (const wchar_t* const path)
+{
+  char mb[1024];
+  if (to_mb (path, mb, sizeof(mb))) remove (mb);
+}
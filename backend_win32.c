@@ -0,0 +1,725 @@
+/* =============================================================================
+// BORDERless: WinAPI backend
+//
+// Everything the library and the app need from Windows itself,
+// see `backend.h`. Window events come from out-of-context WinEvent
+// hooks, timers and display changes through a hidden window of our
+// own: all of them are delivered to the thread which called
+// `borderless_init()` through its message loop.
+// -------------------------------------------------------------------------- */
+
+#ifndef UNICODE
+/* Enable Unicode in WinAPI */
+#define UNICODE
+#endif
+
+#ifndef _UNICODE
+/* Enable Unicode in C runtime */
+#define _UNICODE
+#endif
+
+#ifndef _WIN32_WINNT
+/* Enable Windows 7 features */
+#define _WIN32_WINNT 0x0601
+#endif
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <windows.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <wchar.h>
+#include <io.h>
+#include <sys/stat.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+#include "hook.h"
+
+/* -----------------------------------------------------------------------------
+// Backend variables */
+#define CORE_CLASSNAME L"BORDERlessCore"
+
+/* Hidden window of our own: timers need somewhere to go,
+// and display changes are only broadcast to top-level windows */
+static HWND core_wnd;
+
+/* Not present before Windows 8.1 */
+#define MDT_DEFAULT 3
+typedef HRESULT WINAPI GetDpiForMonitor_fn (HMONITOR hmonitor, int dpiType, UINT* dpiX, UINT* dpiY);
+static GetDpiForMonitor_fn* GetDpiForMonitor;
+
+static HMODULE lib_shcore;
+
+/* DWM window attributes. Not present before Windows Vista,
+// so `dwmapi` is loaded at runtime. */
+#define DWMWA_WINDOW_CORNER_PREFERENCE 33
+#define DWMWA_BORDER_COLOR 34
+#define DWMWCP_DEFAULT 0
+#define DWMWCP_DONOTROUND 1
+#define DWMWA_COLOR_DEFAULT 0xffffffff
+#define DWMWA_COLOR_NONE 0xfffffffe
+
+typedef HRESULT WINAPI DwmSetWindowAttribute_fn (HWND wnd, DWORD attr, LPCVOID val, DWORD size);
+static DwmSetWindowAttribute_fn* DwmSetWindowAttribute;
+
+static HMODULE lib_dwmapi;
+
+#ifndef DBT_DEVNODES_CHANGED
+#define DBT_DEVNODES_CHANGED 0x0007
+#endif
+
+/* -----------------------------------------------------------------------------
+// Windows */
+
+static bool win32_is_maximized (HWND const wnd)
+{
+  WINDOWPLACEMENT place = {.length = sizeof(place)};
+  GetWindowPlacement (wnd, &place);
+  return place.showCmd == SW_SHOWMAXIMIZED;
+}
+
+static bool win32_is_minimized (HWND const wnd)
+{
+  WINDOWPLACEMENT place = {.length = sizeof(place)};
+  GetWindowPlacement (wnd, &place);
+  return place.showCmd == SW_SHOWMINIMIZED;
+}
+
+static void force_repaint_window (const HWND wnd)
+{
+  RECT r;
+  if (win32_is_maximized (wnd)) {
+    InvalidateRect (wnd, NULL, TRUE);
+    UpdateWindow (wnd);
+    return;
+  }
+  GetWindowRect (wnd, &r);
+  MoveWindow (wnd, r.left, r.top, r.right - r.left - 1, r.bottom - r.top - 1, FALSE);
+  MoveWindow (wnd, r.left, r.top, r.right - r.left, r.bottom - r.top, TRUE);
+}
+
+/* Addresses of imported functions aren't constant,
+// hence the thin wrappers. */
+static LONG win32_get_style (HWND const wnd, int const index)
+{
+  return GetWindowLongW (wnd, index);
+}
+
+static LONG win32_set_style (HWND const wnd, int const index, LONG const style)
+{
+  return SetWindowLongW (wnd, index, style);
+}
+
+static HMENU win32_get_menu (HWND const wnd)
+{
+  return GetMenu (wnd);
+}
+
+static bool win32_set_menu (HWND const wnd, HMENU const menu)
+{
+  return SetMenu (wnd, menu);
+}
+
+struct enum_param {
+  backend_enum_fn* fn;
+  void* param;
+};
+
+static BOOL CALLBACK enum_proc (HWND const wnd, LPARAM const lparam)
+{
+  const struct enum_param* const p = (const struct enum_param*)lparam;
+  /* Our own hidden window is nobody's business */
+  if (wnd == core_wnd) return TRUE;
+  return p->fn (wnd, p->param);
+}
+
+static bool win32_enum_windows (backend_enum_fn* const fn, void* const param)
+{
+  struct enum_param p = {fn, param};
+  return EnumWindows (&enum_proc, (LPARAM)&p);
+}
+
+static DWORD win32_get_thread (HWND const wnd)
+{
+  return GetWindowThreadProcessId (wnd, NULL);
+}
+
+static DWORD win32_get_process (HWND const wnd)
+{
+  DWORD pid = 0;
+  GetWindowThreadProcessId (wnd, &pid);
+  return pid;
+}
+
+static int win32_get_class (HWND const wnd, wchar_t* const cls, int const size)
+{
+  return GetClassNameW (wnd, cls, size);
+}
+
+static int win32_get_title (HWND const wnd, wchar_t* const title, int const size)
+{
+  /* Doesn't send `WM_GETTEXT` to other processes: can't hang */
+  return GetWindowTextW (wnd, title, size);
+}
+
+static bool win32_get_exe (DWORD const pid, wchar_t* const path, size_t const size)
+{
+  HANDLE const proc = OpenProcess (PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+  if (proc == NULL) return false;
+  DWORD len = size;
+  const bool ok = QueryFullProcessImageNameW (proc, 0, path, &len);
+  CloseHandle (proc);
+  return ok;
+}
+
+static bool win32_is_top_level (HWND const wnd)
+{
+  return wnd != core_wnd && GetAncestor (wnd, GA_PARENT) == GetDesktopWindow();
+}
+
+static bool win32_is_visible (HWND const wnd)
+{
+  return IsWindowVisible (wnd);
+}
+
+static bool win32_get_rect (HWND const wnd, RECT* const rect)
+{
+  return GetWindowRect (wnd, rect);
+}
+
+static UINT win32_get_dpi (HWND const wnd)
+{
+  UINT dpix_out, dpiy_out;
+  if (GetDpiForMonitor == NULL || GetDpiForMonitor (MonitorFromWindow (wnd
+  , MONITOR_DEFAULTTONEAREST), MDT_DEFAULT, &dpix_out, &dpiy_out) != S_OK) return 0;
+  return dpix_out;
+}
+
+static void win32_frame_changed (HWND const wnd)
+{
+  SetWindowPos (wnd, NULL, 0, 0, 0, 0, SWP_FRAMECHANGED | SWP_NOMOVE
+  | SWP_NOSIZE | SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOACTIVATE);
+}
+
+/* -----------------------------------------------------------------------------
+// Ways of hiding borders other than styles */
+
+static bool win32_dwm_border (HWND const wnd, bool const hide)
+{
+  if (DwmSetWindowAttribute == NULL) return false;
+  /* Non-client rendering policy is deliberately left alone:
+  // disabling it makes Windows fall back to drawing
+  // the classic frame, which is exactly what we
+  // are trying to get rid of. */
+  const DWORD color = hide ? DWMWA_COLOR_NONE : DWMWA_COLOR_DEFAULT;
+  const DWORD corner = hide ? DWMWCP_DONOTROUND : DWMWCP_DEFAULT;
+  /* Both attributes are Windows 11 only: older systems refuse them */
+  if (DwmSetWindowAttribute (wnd, DWMWA_BORDER_COLOR, &color, sizeof(color)) != S_OK) return false;
+  DwmSetWindowAttribute (wnd, DWMWA_WINDOW_CORNER_PREFERENCE, &corner, sizeof(corner));
+  return true;
+}
+
+static bool win32_clip_client (HWND const wnd)
+{
+  RECT wr, cr;
+  POINT origin = {0, 0};
+  if (!GetWindowRect (wnd, &wr) || !GetClientRect (wnd, &cr)) return false;
+  if (!ClientToScreen (wnd, &origin)) return false;
+  /* Region is in window coordinates */
+  const int x = origin.x - wr.left;
+  const int y = origin.y - wr.top;
+  HRGN const rgn = CreateRectRgn (x, y, x + cr.right, y + cr.bottom);
+  if (rgn == NULL) return false;
+  /* The system owns the region from now on */
+  if (!SetWindowRgn (wnd, rgn, TRUE)) {
+    DeleteObject (rgn);
+    return false;
+  }
+  return true;
+}
+
+static void* win32_get_region (HWND const wnd)
+{
+  HRGN const rgn = CreateRectRgn (0, 0, 0, 0);
+  if (rgn == NULL) return NULL;
+  /* Copies the region the window has, fails if there is none */
+  if (GetWindowRgn (wnd, rgn) == ERROR) {
+    DeleteObject (rgn);
+    return NULL;
+  }
+  return rgn;
+}
+
+static void win32_unclip (HWND const wnd, void* const region)
+{
+  if (!SetWindowRgn (wnd, (HRGN)region, TRUE) && region != NULL) {
+    DeleteObject ((HRGN)region);
+  }
+}
+
+static void win32_free_region (void* const region)
+{
+  DeleteObject ((HRGN)region);
+}
+
+/* -----------------------------------------------------------------------------
+// Hook module
+
+// The module must match the bitness of the target, so only targets
+// of the same bitness as BORDERless itself are supported. */
+#define HOOK_MODULE L"borderless_hook.dll"
+
+static HMODULE lib_hook;
+static HOOKPROC hook_proc;
+static HANDLE hook_mapping;
+static struct hook_table* hook_table;
+static HHOOK hook_handles[HOOK_MAX]; // per table entry
+
+static bool hook_load (void)
+{
+  if (hook_proc != NULL) return true;
+  if (hook_table == NULL) {
+    hook_mapping = CreateFileMappingW (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE
+    , 0, sizeof(*hook_table), HOOK_TABLE_NAME);
+    if (hook_mapping == NULL) return false;
+    hook_table = MapViewOfFile (hook_mapping, FILE_MAP_READ | FILE_MAP_WRITE
+    , 0, 0, sizeof(*hook_table));
+    if (hook_table == NULL) {
+      CloseHandle (hook_mapping);
+      hook_mapping = NULL;
+      return false;
+    }
+    /* Leftovers from a previous run are not ours anymore */
+    objzero (hook_table);
+  }
+  if (lib_hook == NULL) lib_hook = LoadLibraryW (HOOK_MODULE);
+  if (lib_hook == NULL) return false;
+  hook_proc = (HOOKPROC)GetProcAddress (lib_hook, HOOK_PROC_NAME);
+  /* Most likely a decorated export: see `build.sh` and `hook.def` */
+  if (hook_proc == NULL) OutputDebugStringW (L"BORDERless: no " TEXT(HOOK_PROC_NAME)
+  L" in " HOOK_MODULE L", frames will not be vetoed\n");
+  return hook_proc != NULL;
+}
+
+static void hook_unload (void)
+{
+  if (lib_hook != NULL) FreeLibrary (lib_hook);
+  if (hook_table != NULL) UnmapViewOfFile (hook_table);
+  if (hook_mapping != NULL) CloseHandle (hook_mapping);
+  lib_hook = NULL;
+  hook_proc = NULL;
+  hook_table = NULL;
+  hook_mapping = NULL;
+}
+
+static bool same_bitness (DWORD const pid)
+{
+  HANDLE const proc = OpenProcess (PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+  if (proc == NULL) return false;
+  BOOL wow_self = FALSE, wow_target = FALSE;
+  const bool ok = IsWow64Process (GetCurrentProcess(), &wow_self)
+  && IsWow64Process (proc, &wow_target);
+  CloseHandle (proc);
+  return ok && wow_self == wow_target;
+}
+
+/* Returns the table entry of the window */
+static void* win32_veto_attach (HWND const wnd, DWORD const thread
+, LONG const mask, LONG const mask_ex)
+{
+  if (!hook_load() || !same_bitness (win32_get_process (wnd))) return NULL;
+
+  /* Find a free entry */
+  struct hook_entry* e = hook_table->entries;
+  while (e != hook_table->entries + hook_table->used && e->wnd != 0) ++e;
+  if (e == hook_table->entries + HOOK_MAX) return NULL;
+  e->mask = mask;
+  e->mask_ex = mask_ex;
+  e->vetoed = 0;
+  InterlockedExchange64 (&e->wnd, (LONG64)(ULONG_PTR)wnd);
+  if (e == hook_table->entries + hook_table->used) InterlockedIncrement (&hook_table->used);
+
+  HHOOK const hook = SetWindowsHookExW (WH_CALLWNDPROC, hook_proc, lib_hook, thread);
+  if (hook == NULL) {
+    InterlockedExchange64 (&e->wnd, 0);
+    return NULL;
+  }
+  hook_handles[e - hook_table->entries] = hook;
+
+  /* Make sure the window gets subclassed right away */
+  DWORD_PTR result;
+  SendMessageTimeoutW (wnd, WM_NULL, 0, 0, SMTO_ABORTIFHUNG, 100, &result);
+  return e;
+}
+
+static long win32_veto_detach (void* const veto)
+{
+  struct hook_entry* const e = veto;
+  HHOOK* const hook = hook_handles + (e - hook_table->entries);
+  /* Entry goes first, so that the module steps aside
+  // before the original styles are put back */
+  InterlockedExchange64 (&e->wnd, 0);
+  const long vetoed = e->vetoed;
+  UnhookWindowsHookEx (hook[0]);
+  hook[0] = NULL;
+  return vetoed;
+}
+
+/* -----------------------------------------------------------------------------
+// Placement */
+
+static HDWP win32_defer_begin (int const num)
+{
+  return BeginDeferWindowPos (num);
+}
+
+static HDWP win32_defer_pos (HDWP const dwp, HWND const wnd, const RECT* const rc
+, UINT const flags)
+{
+  return DeferWindowPos (dwp, wnd, NULL, rc->left, rc->top
+  , rc->right - rc->left, rc->bottom - rc->top, flags);
+}
+
+static bool win32_defer_end (HDWP const dwp)
+{
+  return EndDeferWindowPos (dwp);
+}
+
+static bool win32_set_pos (HWND const wnd, const RECT* const rc, UINT const flags)
+{
+  return SetWindowPos (wnd, NULL, rc->left, rc->top
+  , rc->right - rc->left, rc->bottom - rc->top, flags);
+}
+
+static bool win32_show (HWND const wnd, int const cmd)
+{
+  return ShowWindow (wnd, cmd);
+}
+
+/* `WINDOWPLACEMENT` is in workspace coordinates: relative
+// to the work area, unless it is a tool window */
+static POINT workspace_offset (HWND const wnd, const RECT* const rect)
+{
+  POINT d = {0, 0};
+  if (GetWindowLongW (wnd, GWL_EXSTYLE) & WS_EX_TOOLWINDOW) return d;
+  MONITORINFO mi = {.cbSize = sizeof(mi)};
+  if (GetMonitorInfoW (MonitorFromRect (rect, MONITOR_DEFAULTTONEAREST), &mi)) {
+    d.x = mi.rcWork.left - mi.rcMonitor.left;
+    d.y = mi.rcWork.top - mi.rcMonitor.top;
+  }
+  return d;
+}
+
+static bool win32_get_placement (HWND const wnd, RECT* const rect, bool* const maximized)
+{
+  WINDOWPLACEMENT place = {.length = sizeof(place)};
+  if (!GetWindowPlacement (wnd, &place)) return false;
+  const POINT d = workspace_offset (wnd, &place.rcNormalPosition);
+  rect[0] = place.rcNormalPosition;
+  OffsetRect (rect, d.x, d.y);
+  maximized[0] = place.showCmd == SW_SHOWMAXIMIZED;
+  return true;
+}
+
+static bool win32_set_placement (HWND const wnd, const RECT* const rect, bool const maximized)
+{
+  WINDOWPLACEMENT place = {.length = sizeof(place)};
+  if (!GetWindowPlacement (wnd, &place)) return false;
+  const POINT d = workspace_offset (wnd, rect);
+  place.rcNormalPosition = rect[0];
+  OffsetRect (&place.rcNormalPosition, -d.x, -d.y);
+  place.flags = 0;
+  place.showCmd = maximized ? SW_SHOWMAXIMIZED : SW_SHOWNOACTIVATE;
+  /* There is no maximizing without activating: give the foreground back */
+  HWND const fg = GetForegroundWindow();
+  const bool ok = SetWindowPlacement (wnd, &place);
+  if (fg != NULL && fg != wnd && GetForegroundWindow() == wnd) SetForegroundWindow (fg);
+  return ok;
+}
+
+struct monitor_param {
+  RECT* rects;
+  size_t max;
+  size_t num;
+};
+
+static BOOL CALLBACK monitor_enum (HMONITOR const mon, HDC const dc
+, LPRECT const rect, LPARAM const lparam)
+{
+  struct monitor_param* const p = (struct monitor_param*)lparam;
+  if (p->num < p->max) p->rects[p->num] = rect[0];
+  ++p->num;
+  return TRUE;
+}
+
+static size_t win32_get_monitors (RECT* const rects, size_t const max)
+{
+  struct monitor_param p = {rects, max, 0};
+  EnumDisplayMonitors (NULL, NULL, &monitor_enum, (LPARAM)&p);
+  return p.num;
+}
+
+/* -----------------------------------------------------------------------------
+// Hotkeys */
+
+static bool win32_register_hotkey (HWND const wnd, int const id
+, UINT const mod, UINT const code)
+{
+  return RegisterHotKey (wnd, id, mod, code);
+}
+
+static bool win32_unregister_hotkey (HWND const wnd, int const id)
+{
+  return UnregisterHotKey (wnd, id);
+}
+
+/* -----------------------------------------------------------------------------
+// Files */
+
+static wchar_t* win32_file_read (const wchar_t* const path)
+{
+  struct __stat64 stat;
+  if (_wstat64 (path, &stat) == -1 || (stat.st_size & 1)) return NULL;
+
+  /* Text mode only ever makes it shorter */
+  const size_t size = stat.st_size / sizeof(wchar_t) + 1;
+  wchar_t* const text = arrnew (wchar_t, size);
+  if (text == NULL) return NULL;
+  FILE* const f = _wfopen (path, L"r,ccs=UTF-16LE");
+  if (f == NULL) {
+    free (text);
+    return NULL;
+  }
+  size_t len = 0;
+  text[0] = '\0';
+  while (len + 1 < size && fgetws (text + len, size - len, f) != NULL) {
+    len += wcslen (text + len);
+  }
+  const bool ok = !ferror (f);
+  fclose (f);
+  if (!ok) {
+    free (text);
+    return NULL;
+  }
+  return text;
+}
+
+static bool win32_file_write (const wchar_t* const path, const wchar_t* const text)
+{
+  FILE* const f = _wfopen (path, L"wt,ccs=UTF-16LE");
+  if (f == NULL) return false;
+  const bool ok = fputws (text, f) >= 0 && fflush (f) == 0
+  && _commit (_fileno (f)) == 0;
+  return fclose (f) == 0 && ok;
+}
+
+static bool win32_file_replace (const wchar_t* const src, const wchar_t* const dst)
+{
+  return MoveFileExW (src, dst, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+}
+
+static void win32_file_remove (const wchar_t* const path)
+{
+  _wremove (path);
+}
+
+/* -----------------------------------------------------------------------------
+// Events and timers */
+
+static HWINEVENTHOOK inventory_hooks[2];
+static HWINEVENTHOOK location_hook;
+
+static void CALLBACK event_proc (HWINEVENTHOOK const hook, DWORD const event
+, HWND const wnd, LONG const obj, LONG const child, DWORD const thread, DWORD const time)
+{
+  /* Caret and cursor moves come through here too: keep it cheap */
+  if (wnd == NULL || wnd == core_wnd || obj != OBJID_WINDOW || child != CHILDID_SELF) return;
+  switch (event) {
+  case EVENT_OBJECT_CREATE:         core_event (CORE_EVENT_CREATE, wnd); break;
+  case EVENT_OBJECT_DESTROY:        core_event (CORE_EVENT_DESTROY, wnd); break;
+  case EVENT_OBJECT_SHOW:           core_event (CORE_EVENT_SHOW, wnd); break;
+  case EVENT_OBJECT_HIDE:           core_event (CORE_EVENT_HIDE, wnd); break;
+  case EVENT_OBJECT_NAMECHANGE:     core_event (CORE_EVENT_NAMECHANGE, wnd); break;
+  case EVENT_OBJECT_LOCATIONCHANGE: core_event (CORE_EVENT_LOCATION, wnd); break;
+  }
+}
+
+static void unhook (HWINEVENTHOOK* const hook)
+{
+  if (hook[0] != NULL) UnhookWinEvent (hook[0]);
+  hook[0] = NULL;
+}
+
+static bool win32_watch (enum core_watch const what, bool const on)
+{
+  if (what == CORE_WATCH_WINDOWS) {
+    if (!on) {
+      unhook (inventory_hooks + 0);
+      unhook (inventory_hooks + 1);
+      return true;
+    }
+    if (inventory_hooks[0] == NULL) inventory_hooks[0] = SetWinEventHook (EVENT_OBJECT_CREATE
+    , EVENT_OBJECT_HIDE, NULL, &event_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
+    if (inventory_hooks[1] == NULL) inventory_hooks[1] = SetWinEventHook (EVENT_OBJECT_NAMECHANGE
+    , EVENT_OBJECT_NAMECHANGE, NULL, &event_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
+    return inventory_hooks[0] != NULL && inventory_hooks[1] != NULL;
+  }
+  if (!on) {
+    unhook (&location_hook);
+    return true;
+  }
+  if (location_hook == NULL) location_hook = SetWinEventHook (EVENT_OBJECT_LOCATIONCHANGE
+  , EVENT_OBJECT_LOCATIONCHANGE, NULL, &event_proc, 0, 0
+  , WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+  return location_hook != NULL;
+}
+
+static bool win32_set_timer (UINT const id, UINT const ms)
+{
+  return SetTimer (core_wnd, id, ms, NULL) != 0;
+}
+
+static void win32_kill_timer (UINT const id)
+{
+  KillTimer (core_wnd, id);
+}
+
+static LRESULT CALLBACK core_wnd_proc (HWND const wnd, UINT const msg
+, WPARAM const wparam, LPARAM const lparam)
+{
+  switch (msg) {
+  /* Display topology or resolution changes */
+  case WM_DISPLAYCHANGE:
+    core_display_changed();
+    return 0;
+  case WM_DEVICECHANGE:
+    if (wparam == DBT_DEVNODES_CHANGED) core_display_changed();
+    return TRUE;
+  case WM_TIMER:
+    core_timer (wparam);
+    return 0;
+  }
+  return DefWindowProcW (wnd, msg, wparam, lparam);
+}
+
+/* -----------------------------------------------------------------------------
+// Lifetime */
+
+/* Module the library ended up in: the app or `libborderless.dll` */
+static HINSTANCE core_instance (void)
+{
+  HMODULE inst = NULL;
+  GetModuleHandleExW (GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS
+  | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)&core_wnd_proc, &inst);
+  return inst;
+}
+
+static void win32_close (void)
+{
+  unhook (&location_hook);
+  unhook (inventory_hooks + 0);
+  unhook (inventory_hooks + 1);
+  if (core_wnd != NULL) {
+    DestroyWindow (core_wnd);
+    core_wnd = NULL;
+    UnregisterClassW (CORE_CLASSNAME, core_instance());
+  }
+  hook_unload();
+  if (lib_dwmapi != NULL) FreeLibrary (lib_dwmapi);
+  lib_dwmapi = NULL;
+  DwmSetWindowAttribute = NULL;
+  if (lib_shcore != NULL) FreeLibrary (lib_shcore);
+  lib_shcore = NULL;
+  GetDpiForMonitor = NULL;
+}
+
+static bool win32_open (void)
+{
+  /* Both are optional: the former is only needed for regions
+  // to follow DPI, the latter for DWM border hiding mode */
+  lib_shcore = LoadLibraryW (L"shcore");
+  if (lib_shcore != NULL) {
+    GetDpiForMonitor = (GetDpiForMonitor_fn*)GetProcAddress (lib_shcore, "GetDpiForMonitor");
+  }
+  lib_dwmapi = LoadLibraryW (L"dwmapi");
+  if (lib_dwmapi != NULL) {
+    DwmSetWindowAttribute = (DwmSetWindowAttribute_fn*)GetProcAddress (lib_dwmapi, "DwmSetWindowAttribute");
+  }
+
+  HINSTANCE const inst = core_instance();
+  WNDCLASSEXW wclx = {
+    .cbSize        = sizeof (wclx),
+    .lpfnWndProc   = &core_wnd_proc,
+    .hInstance     = inst,
+    .lpszClassName = CORE_CLASSNAME
+  };
+  if (RegisterClassExW (&wclx) != 0) {
+    core_wnd = CreateWindowExW (WS_EX_TOOLWINDOW, CORE_CLASSNAME, L"", WS_POPUP
+    , 0, 0, 0, 0, NULL, NULL, inst, NULL);
+    if (core_wnd == NULL) UnregisterClassW (CORE_CLASSNAME, inst);
+  }
+  if (core_wnd == NULL) {
+    win32_close();
+    return false;
+  }
+  return true;
+}
+
+static DWORD win32_current_thread (void)
+{
+  return GetCurrentThreadId();
+}
+
+const struct backend backend_win32 = {
+  .open              = &win32_open,
+  .close             = &win32_close,
+  .current_thread    = &win32_current_thread,
+  .set_timer         = &win32_set_timer,
+  .kill_timer        = &win32_kill_timer,
+  .watch             = &win32_watch,
+  .get_style         = &win32_get_style,
+  .set_style         = &win32_set_style,
+  .get_menu          = &win32_get_menu,
+  .set_menu          = &win32_set_menu,
+  .enum_windows      = &win32_enum_windows,
+  .get_thread        = &win32_get_thread,
+  .get_process       = &win32_get_process,
+  .get_class         = &win32_get_class,
+  .get_title         = &win32_get_title,
+  .get_exe           = &win32_get_exe,
+  .is_top_level      = &win32_is_top_level,
+  .is_visible        = &win32_is_visible,
+  .is_minimized      = &win32_is_minimized,
+  .is_maximized      = &win32_is_maximized,
+  .get_rect          = &win32_get_rect,
+  .get_dpi           = &win32_get_dpi,
+  .repaint           = &force_repaint_window,
+  .frame_changed     = &win32_frame_changed,
+  .dwm_border        = &win32_dwm_border,
+  .clip_client       = &win32_clip_client,
+  .get_region        = &win32_get_region,
+  .unclip            = &win32_unclip,
+  .free_region       = &win32_free_region,
+  .veto_attach       = &win32_veto_attach,
+  .veto_detach       = &win32_veto_detach,
+  .defer_begin       = &win32_defer_begin,
+  .defer_pos         = &win32_defer_pos,
+  .defer_end         = &win32_defer_end,
+  .set_pos           = &win32_set_pos,
+  .show              = &win32_show,
+  .get_placement     = &win32_get_placement,
+  .set_placement     = &win32_set_placement,
+  .get_monitors      = &win32_get_monitors,
+  .register_hotkey   = &win32_register_hotkey,
+  .unregister_hotkey = &win32_unregister_hotkey,
+  .file_read         = &win32_file_read,
+  .file_write        = &win32_file_write,
+  .file_replace      = &win32_file_replace,
+  .file_remove       = &win32_file_remove
+};
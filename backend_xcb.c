@@ -0,0 +1,1101 @@
+/* =============================================================================
+// BORDERless: X11 backend, see `backend.h`
+//
+// Window handles are X window ids of the clients listed by the window
+// manager in `_NET_CLIENT_LIST`. Frame styles map to the decorations of
+// `_MOTIF_WM_HINTS`, the DWM mode to `_NET_WM_STATE_FULLSCREEN`, hotkeys
+// to key grabs on the root window. X has no menu bars, window regions
+// without the Shape extension, or hook modules: those report failure
+// and the core falls back to style masks.
+//
+// Requests are pipelined: replies are only waited for once everything
+// needed is asked for. Window properties are fetched for all clients
+// in one go when windows are enumerated, and kept until the next batch
+// of events, so toggling a batch of windows costs one round trip.
+// -------------------------------------------------------------------------- */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <xcb/xcb.h>
+#include <X11/keysym.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+
+/* -----------------------------------------------------------------------------
+// Backend variables */
+#define XCB_TIMERS 8
+#define XCB_HOTKEYS_MAX 16
+#define XCB_CLASS_MAX 128
+
+static xcb_connection_t* conn;
+static xcb_window_t root;
+static UINT screen_dpi;
+static RECT screen_rect;
+
+enum atom {
+  ATOM_MOTIF_WM_HINTS,
+  ATOM_NET_SUPPORTED,
+  ATOM_NET_CLIENT_LIST,
+  ATOM_NET_ACTIVE_WINDOW,
+  ATOM_NET_WM_PID,
+  ATOM_NET_WM_NAME,
+  ATOM_UTF8_STRING,
+  ATOM_NET_WM_STATE,
+  ATOM_NET_WM_STATE_FULLSCREEN,
+  ATOM_NET_WM_STATE_MAXIMIZED_VERT,
+  ATOM_NET_WM_STATE_MAXIMIZED_HORZ,
+  ATOM_NET_WM_STATE_HIDDEN,
+  ATOM_WM_CHANGE_STATE,
+  ATOM_COUNT
+};
+
+static const char* const atom_names[ATOM_COUNT] = {
+  [ATOM_MOTIF_WM_HINTS]              = "_MOTIF_WM_HINTS",
+  [ATOM_NET_SUPPORTED]               = "_NET_SUPPORTED",
+  [ATOM_NET_CLIENT_LIST]             = "_NET_CLIENT_LIST",
+  [ATOM_NET_ACTIVE_WINDOW]           = "_NET_ACTIVE_WINDOW",
+  [ATOM_NET_WM_PID]                  = "_NET_WM_PID",
+  [ATOM_NET_WM_NAME]                 = "_NET_WM_NAME",
+  [ATOM_UTF8_STRING]                 = "UTF8_STRING",
+  [ATOM_NET_WM_STATE]                = "_NET_WM_STATE",
+  [ATOM_NET_WM_STATE_FULLSCREEN]     = "_NET_WM_STATE_FULLSCREEN",
+  [ATOM_NET_WM_STATE_MAXIMIZED_VERT] = "_NET_WM_STATE_MAXIMIZED_VERT",
+  [ATOM_NET_WM_STATE_MAXIMIZED_HORZ] = "_NET_WM_STATE_MAXIMIZED_HORZ",
+  [ATOM_NET_WM_STATE_HIDDEN]         = "_NET_WM_STATE_HIDDEN",
+  [ATOM_WM_CHANGE_STATE]             = "WM_CHANGE_STATE"
+};
+
+static xcb_atom_t atoms[ATOM_COUNT];
+static bool fullscreen_supported;
+
+static inline xcb_window_t xwnd (HWND const wnd)
+{
+  return (xcb_window_t)(uintptr_t)wnd;
+}
+
+static inline HWND hwnd (xcb_window_t const wnd)
+{
+  return (HWND)(uintptr_t)wnd;
+}
+
+/* -----------------------------------------------------------------------------
+// Window properties
+
+// Everything the core asks about most, fetched with a single batch of
+// requests per window and kept until events say things have changed. */
+
+/* `_MOTIF_WM_HINTS` as in Motif's MwmUtil.h */
+#define MWM_HINTS_DECORATIONS (1 << 1)
+#define MWM_DECOR_ALL      (1 << 0)
+#define MWM_DECOR_BORDER   (1 << 1)
+#define MWM_DECOR_RESIZEH  (1 << 2)
+#define MWM_DECOR_TITLE    (1 << 3)
+#define MWM_DECOR_MENU     (1 << 4)
+#define MWM_DECOR_MINIMIZE (1 << 5)
+#define MWM_DECOR_MAXIMIZE (1 << 6)
+#define MWM_HINTS_SIZE 5
+
+static const struct {
+  uint32_t decor;
+  LONG style;
+} decor_styles[] = {
+  {MWM_DECOR_BORDER,   WS_BORDER},
+  {MWM_DECOR_RESIZEH,  WS_THICKFRAME},
+  {MWM_DECOR_TITLE,    WS_DLGFRAME},
+  {MWM_DECOR_MENU,     WS_SYSMENU},
+  {MWM_DECOR_MINIMIZE, WS_MINIMIZEBOX},
+  {MWM_DECOR_MAXIMIZE, WS_MAXIMIZEBOX}
+};
+
+struct xwindow {
+  xcb_window_t wnd;
+  bool alive;
+  bool viewable;
+  bool fullscreen, maximized, hidden;
+  uint32_t pid;
+  uint32_t motif[MWM_HINTS_SIZE]; // all zero if not set
+  char cls[XCB_CLASS_MAX];
+};
+
+static size_t cache_size;
+static size_t cache_cap;
+static struct xwindow* cache;
+
+/* `_NET_CLIENT_LIST` as last seen, sorted */
+static size_t client_num;
+static size_t client_cap;
+static xcb_window_t* clients;
+static bool clients_valid;
+
+struct xwindow_cookies {
+  xcb_get_window_attributes_cookie_t attr;
+  xcb_get_property_cookie_t motif, pid, state, cls;
+};
+
+/* ICCCM `WM_STATE` value asked for by `WM_CHANGE_STATE` */
+#define WM_STATE_ICONIC 3
+
+static struct xwindow_cookies xwindow_request (xcb_window_t const wnd)
+{
+  return (struct xwindow_cookies){
+    .attr = xcb_get_window_attributes (conn, wnd),
+    .motif = xcb_get_property (conn, 0, wnd, atoms[ATOM_MOTIF_WM_HINTS]
+    , atoms[ATOM_MOTIF_WM_HINTS], 0, MWM_HINTS_SIZE),
+    .pid = xcb_get_property (conn, 0, wnd, atoms[ATOM_NET_WM_PID], XCB_ATOM_CARDINAL, 0, 1),
+    .state = xcb_get_property (conn, 0, wnd, atoms[ATOM_NET_WM_STATE], XCB_ATOM_ATOM, 0, 32),
+    .cls = xcb_get_property (conn, 0, wnd, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING
+    , 0, XCB_CLASS_MAX / 4)
+  };
+}
+
+static void xwindow_reply (struct xwindow* const w, const struct xwindow_cookies* const c)
+{
+  xcb_get_window_attributes_reply_t* const attr = xcb_get_window_attributes_reply (conn, c->attr, NULL);
+  xcb_get_property_reply_t* const motif = xcb_get_property_reply (conn, c->motif, NULL);
+  xcb_get_property_reply_t* const pid = xcb_get_property_reply (conn, c->pid, NULL);
+  xcb_get_property_reply_t* const state = xcb_get_property_reply (conn, c->state, NULL);
+  xcb_get_property_reply_t* const cls = xcb_get_property_reply (conn, c->cls, NULL);
+
+  w->alive = attr != NULL;
+  w->viewable = attr != NULL && attr->map_state == XCB_MAP_STATE_VIEWABLE;
+  if (motif != NULL && motif->format == 32
+  && xcb_get_property_value_length (motif) == sizeof(w->motif)) {
+    memcpy (w->motif, xcb_get_property_value (motif), sizeof(w->motif));
+  }
+  if (pid != NULL && pid->format == 32 && xcb_get_property_value_length (pid) == 4) {
+    w->pid = ((const uint32_t*)xcb_get_property_value (pid))[0];
+  }
+  if (state != NULL && state->format == 32) {
+    const xcb_atom_t* const a = xcb_get_property_value (state);
+    const size_t num = xcb_get_property_value_length (state) / 4;
+    bool vert = false, horz = false;
+    for (size_t i = 0; i != num; ++i) {
+      if      (a[i] == atoms[ATOM_NET_WM_STATE_FULLSCREEN])     w->fullscreen = true;
+      else if (a[i] == atoms[ATOM_NET_WM_STATE_HIDDEN])         w->hidden = true;
+      else if (a[i] == atoms[ATOM_NET_WM_STATE_MAXIMIZED_VERT]) vert = true;
+      else if (a[i] == atoms[ATOM_NET_WM_STATE_MAXIMIZED_HORZ]) horz = true;
+    }
+    w->maximized = vert && horz;
+  }
+  /* Instance name, then class name */
+  if (cls != NULL && cls->format == 8) {
+    const char* const s = xcb_get_property_value (cls);
+    const size_t len = xcb_get_property_value_length (cls);
+    const char* const name = memchr (s, '\0', len);
+    if (name != NULL && (size_t)(name + 1 - s) < len) {
+      const size_t n = len - (name + 1 - s);
+      const size_t copy = n < sizeof(w->cls) - 1 ? n : sizeof(w->cls) - 1;
+      memcpy (w->cls, name + 1, copy);
+      w->cls[copy] = '\0';
+    }
+  }
+  free (attr);
+  free (motif);
+  free (pid);
+  free (state);
+  free (cls);
+}
+
+static struct xwindow* cache_find (xcb_window_t const wnd)
+{
+  for (size_t i = 0; i != cache_size; ++i) {
+    if (cache[i].wnd == wnd) return cache + i;
+  }
+  return NULL;
+}
+
+/* Everything about `num` windows in one round trip */
+static void cache_fill (const xcb_window_t* const wnds, size_t const num)
+{
+  struct xwindow_cookies* const c = arrnew (struct xwindow_cookies, num);
+  if (c == NULL) return;
+  size_t asked = 0;
+  for (size_t i = 0; i != num; ++i) {
+    if (cache_find (wnds[i]) != NULL) continue;
+    if (!arrreserve (cache, cache_size, cache_cap)) break;
+    c[asked] = xwindow_request (wnds[i]);
+    cache[cache_size] = (struct xwindow){.wnd = wnds[i]};
+    ++cache_size;
+    ++asked;
+  }
+  for (size_t i = 0; i != asked; ++i) {
+    xwindow_reply (cache + cache_size - asked + i, c + i);
+  }
+  free (c);
+}
+
+static struct xwindow* cache_get (HWND const wnd)
+{
+  if (wnd == NULL) return NULL;
+  struct xwindow* w = cache_find (xwnd (wnd));
+  if (w == NULL) {
+    const xcb_window_t x = xwnd (wnd);
+    cache_fill (&x, 1);
+    w = cache_find (x);
+  }
+  return w != NULL && w->alive ? w : NULL;
+}
+
+/* Events may have changed anything */
+static void cache_clear (void)
+{
+  cache_size = 0;
+  clients_valid = false;
+}
+
+static int cmp_window (const void* const a, const void* const b)
+{
+  const xcb_window_t x = *(const xcb_window_t*)a, y = *(const xcb_window_t*)b;
+  return (x > y) - (x < y);
+}
+
+static bool clients_fetch (void)
+{
+  if (clients_valid) return true;
+  xcb_get_property_reply_t* const r = xcb_get_property_reply (conn
+  , xcb_get_property (conn, 0, root, atoms[ATOM_NET_CLIENT_LIST], XCB_ATOM_WINDOW, 0, UINT32_MAX / 4)
+  , NULL);
+  if (r == NULL) return false;
+  const size_t num = r->format == 32 ? xcb_get_property_value_length (r) / 4 : 0;
+  if (num > client_cap) {
+    xcb_window_t* const p = arrnewsize (clients, num);
+    if (p == NULL) {
+      free (r);
+      return false;
+    }
+    clients = p;
+    client_cap = num;
+  }
+  if (num != 0) memcpy (clients, xcb_get_property_value (r), num * sizeof(clients[0]));
+  client_num = num;
+  free (r);
+  qsort (clients, client_num, sizeof(clients[0]), &cmp_window);
+  clients_valid = true;
+  return true;
+}
+
+static bool is_client (xcb_window_t const wnd)
+{
+  if (!clients_fetch()) return false;
+  return bsearch (&wnd, clients, client_num, sizeof(clients[0]), &cmp_window) != NULL;
+}
+
+/* -----------------------------------------------------------------------------
+// Utilities */
+
+static inline long long now_ms (void)
+{
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000ll + t.tv_nsec / 1000000;
+}
+
+/* EWMH state change: asked of the window manager, not set directly */
+static void wm_state (xcb_window_t const wnd, bool const add
+, xcb_atom_t const a, xcb_atom_t const b)
+{
+  xcb_client_message_event_t ev = {
+    .response_type = XCB_CLIENT_MESSAGE,
+    .format = 32,
+    .window = wnd,
+    .type = atoms[ATOM_NET_WM_STATE],
+    .data.data32 = {add ? 1 : 0, a, b, 1, 0}
+  };
+  xcb_send_event (conn, 0, root, XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT
+  | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, (const char*)&ev);
+}
+
+static size_t to_wide (const char* const s, wchar_t* const out, size_t const size)
+{
+  if (size == 0) return 0;
+  size_t len = mbstowcs (out, s, size - 1);
+  if (len == (size_t)-1) len = 0;
+  out[len] = '\0';
+  return len;
+}
+
+/* -----------------------------------------------------------------------------
+// Windows */
+
+static LONG xcb_get_style (HWND const wnd, int const index)
+{
+  const struct xwindow* const w = cache_get (wnd);
+  if (w == NULL) return 0;
+  /* No extended styles on X: just something for the core to keep */
+  if (index != GWL_STYLE) return WS_EX_WINDOWEDGE;
+  LONG style = w->viewable ? WS_VISIBLE : 0;
+  if (!(w->motif[0] & MWM_HINTS_DECORATIONS) || (w->motif[2] & MWM_DECOR_ALL)) {
+    return style | WS_OVERLAPPEDWINDOW;
+  }
+  for (size_t i = 0; i != numof(decor_styles); ++i) {
+    if (w->motif[2] & decor_styles[i].decor) style |= decor_styles[i].style;
+  }
+  return style;
+}
+
+static LONG xcb_set_style (HWND const wnd, int const index, LONG const style)
+{
+  const LONG old = xcb_get_style (wnd, index);
+  struct xwindow* const w = cache_get (wnd);
+  if (w == NULL || index != GWL_STYLE) return old;
+  uint32_t decor = 0;
+  for (size_t i = 0; i != numof(decor_styles); ++i) {
+    if (style & decor_styles[i].style) decor |= decor_styles[i].decor;
+  }
+  w->motif[0] |= MWM_HINTS_DECORATIONS;
+  w->motif[2] = decor;
+  xcb_change_property (conn, XCB_PROP_MODE_REPLACE, w->wnd, atoms[ATOM_MOTIF_WM_HINTS]
+  , atoms[ATOM_MOTIF_WM_HINTS], 32, MWM_HINTS_SIZE, w->motif);
+  return old;
+}
+
+static HMENU xcb_get_menu (HWND const wnd)
+{
+  return NULL;
+}
+
+static bool xcb_set_menu (HWND const wnd, HMENU const menu)
+{
+  return false;
+}
+
+static bool xcb_enum_windows (backend_enum_fn* const fn, void* const param)
+{
+  if (!clients_fetch()) return false;
+  /* Callbacks ask about every window: get it all at once */
+  cache_fill (clients, client_num);
+  /* The list may change under the callback */
+  xcb_window_t* const wnds = arrnew (xcb_window_t, client_num);
+  if (wnds == NULL && client_num != 0) return false;
+  const size_t num = client_num;
+  if (num != 0) arrcopy (wnds, clients, num);
+  for (size_t i = 0; i != num; ++i) {
+    if (!fn (hwnd (wnds[i]), param)) break;
+  }
+  free (wnds);
+  return true;
+}
+
+/* X has no threads of windows. Process ids tell reused ids apart
+// well enough, windows without one are taken as themselves. */
+static DWORD xcb_get_thread (HWND const wnd)
+{
+  const struct xwindow* const w = cache_get (wnd);
+  if (w == NULL) return 0;
+  return w->pid != 0 ? w->pid : 1;
+}
+
+static DWORD xcb_get_process (HWND const wnd)
+{
+  const struct xwindow* const w = cache_get (wnd);
+  return w != NULL ? w->pid : 0;
+}
+
+static int xcb_get_class (HWND const wnd, wchar_t* const cls, int const size)
+{
+  const struct xwindow* const w = cache_get (wnd);
+  if (w == NULL || size <= 0) return 0;
+  return (int)to_wide (w->cls, cls, size);
+}
+
+static int xcb_get_title (HWND const wnd, wchar_t* const title, int const size)
+{
+  if (size <= 0) return 0;
+  xcb_get_property_cookie_t const net = xcb_get_property (conn, 0, xwnd (wnd)
+  , atoms[ATOM_NET_WM_NAME], atoms[ATOM_UTF8_STRING], 0, size);
+  xcb_get_property_cookie_t const icccm = xcb_get_property (conn, 0, xwnd (wnd)
+  , XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 0, size);
+  xcb_get_property_reply_t* const r[2] = {
+    xcb_get_property_reply (conn, net, NULL),
+    xcb_get_property_reply (conn, icccm, NULL)
+  };
+  int len = 0;
+  for (int i = 0; i != 2 && len == 0; ++i) {
+    if (r[i] == NULL || r[i]->format != 8) continue;
+    const int n = xcb_get_property_value_length (r[i]);
+    char* const s = malloc (n + 1);
+    if (s == NULL) continue;
+    memcpy (s, xcb_get_property_value (r[i]), n);
+    s[n] = '\0';
+    len = (int)to_wide (s, title, size);
+    free (s);
+  }
+  free (r[0]);
+  free (r[1]);
+  if (len == 0) title[0] = '\0';
+  return len;
+}
+
+static bool xcb_get_exe (DWORD const pid, wchar_t* const path, size_t const size)
+{
+  char link[64], exe[1024];
+  snprintf (link, sizeof(link), "/proc/%lu/exe", (unsigned long)pid);
+  const ssize_t len = readlink (link, exe, sizeof(exe) - 1);
+  if (len <= 0) return false;
+  exe[len] = '\0';
+  return to_wide (exe, path, size) != 0;
+}
+
+static bool xcb_is_top_level (HWND const wnd)
+{
+  return wnd != NULL && is_client (xwnd (wnd));
+}
+
+static bool xcb_is_visible (HWND const wnd)
+{
+  const struct xwindow* const w = cache_get (wnd);
+  return w != NULL && w->viewable;
+}
+
+static bool xcb_is_minimized (HWND const wnd)
+{
+  const struct xwindow* const w = cache_get (wnd);
+  return w != NULL && w->hidden;
+}
+
+static bool xcb_is_maximized (HWND const wnd)
+{
+  const struct xwindow* const w = cache_get (wnd);
+  return w != NULL && w->maximized;
+}
+
+static bool xcb_get_rect (HWND const wnd, RECT* const rect)
+{
+  xcb_get_geometry_cookie_t const gc = xcb_get_geometry (conn, xwnd (wnd));
+  xcb_translate_coordinates_cookie_t const tc = xcb_translate_coordinates (conn
+  , xwnd (wnd), root, 0, 0);
+  xcb_get_geometry_reply_t* const g = xcb_get_geometry_reply (conn, gc, NULL);
+  xcb_translate_coordinates_reply_t* const t = xcb_translate_coordinates_reply (conn, tc, NULL);
+  const bool ok = g != NULL && t != NULL;
+  if (ok) {
+    rect->left = t->dst_x;
+    rect->top = t->dst_y;
+    rect->right = t->dst_x + g->width;
+    rect->bottom = t->dst_y + g->height;
+  }
+  free (g);
+  free (t);
+  return ok;
+}
+
+static UINT xcb_get_dpi (HWND const wnd)
+{
+  return screen_dpi;
+}
+
+/* Window managers redecorate on their own once the hints change */
+static void xcb_repaint (HWND const wnd)
+{
+  xcb_flush (conn);
+}
+
+static void xcb_frame_changed (HWND const wnd)
+{
+  xcb_flush (conn);
+}
+
+/* -----------------------------------------------------------------------------
+// Ways of hiding borders other than styles */
+
+/* Fullscreen state: the window manager drops the decorations itself */
+static bool xcb_dwm_border (HWND const wnd, bool const hide)
+{
+  struct xwindow* const w = cache_get (wnd);
+  if (w == NULL || !fullscreen_supported) return false;
+  wm_state (w->wnd, hide, atoms[ATOM_NET_WM_STATE_FULLSCREEN], 0);
+  w->fullscreen = hide;
+  xcb_flush (conn);
+  return true;
+}
+
+static bool xcb_clip_client (HWND const wnd)
+{
+  return false;
+}
+
+static void* xcb_get_region (HWND const wnd)
+{
+  return NULL;
+}
+
+static void xcb_unclip (HWND const wnd, void* const region)
+{
+}
+
+static void xcb_free_region (void* const region)
+{
+}
+
+static void* xcb_veto_attach (HWND const wnd, DWORD const thread
+, LONG const mask, LONG const mask_ex)
+{
+  return NULL;
+}
+
+static long xcb_veto_detach (void* const veto)
+{
+  return 0;
+}
+
+/* -----------------------------------------------------------------------------
+// Placement
+
+// Requests without replies are only queued: a batch goes out
+// in one write when it ends. */
+
+static void configure (xcb_window_t const wnd, const RECT* const rect, UINT const flags)
+{
+  uint16_t mask = 0;
+  uint32_t values[4];
+  int n = 0;
+  if (!(flags & SWP_NOMOVE)) {
+    mask |= XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y;
+    values[n++] = (uint32_t)rect->left;
+    values[n++] = (uint32_t)rect->top;
+  }
+  if (!(flags & SWP_NOSIZE)) {
+    mask |= XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT;
+    values[n++] = (uint32_t)(rect->right - rect->left);
+    values[n++] = (uint32_t)(rect->bottom - rect->top);
+  }
+  if (mask != 0) xcb_configure_window (conn, wnd, mask, values);
+}
+
+static HDWP xcb_defer_begin (int const num)
+{
+  static char batch;
+  return (HDWP)&batch;
+}
+
+static HDWP xcb_defer_pos (HDWP const dwp, HWND const wnd, const RECT* const rect
+, UINT const flags)
+{
+  configure (xwnd (wnd), rect, flags);
+  return dwp;
+}
+
+static bool xcb_defer_end (HDWP const dwp)
+{
+  return xcb_flush (conn) > 0;
+}
+
+static bool xcb_set_pos (HWND const wnd, const RECT* const rect, UINT const flags)
+{
+  configure (xwnd (wnd), rect, flags);
+  return xcb_flush (conn) > 0;
+}
+
+static bool xcb_show (HWND const wnd, int const cmd)
+{
+  struct xwindow* const w = cache_get (wnd);
+  if (w == NULL) return false;
+  const xcb_atom_t vert = atoms[ATOM_NET_WM_STATE_MAXIMIZED_VERT];
+  const xcb_atom_t horz = atoms[ATOM_NET_WM_STATE_MAXIMIZED_HORZ];
+  switch (cmd) {
+  case SW_SHOWMAXIMIZED:
+    wm_state (w->wnd, true, vert, horz);
+    w->maximized = true;
+    break;
+  case SW_SHOWMINIMIZED:
+  case SW_SHOWMINNOACTIVE: {
+    /* ICCCM: ask for the iconic state */
+    xcb_client_message_event_t ev = {
+      .response_type = XCB_CLIENT_MESSAGE,
+      .format = 32,
+      .window = w->wnd,
+      .type = atoms[ATOM_WM_CHANGE_STATE],
+      .data.data32 = {WM_STATE_ICONIC}
+    };
+    xcb_send_event (conn, 0, root, XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT
+    | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, (const char*)&ev);
+    w->hidden = true;
+    break;
+  }
+  default:
+    if (!w->viewable) xcb_map_window (conn, w->wnd);
+    if (w->maximized) wm_state (w->wnd, false, vert, horz);
+    w->maximized = false;
+    break;
+  }
+  return xcb_flush (conn) > 0;
+}
+
+/* Window managers keep the restored geometry to themselves:
+// the current one is the best guess */
+static bool xcb_get_placement (HWND const wnd, RECT* const rect, bool* const maximized)
+{
+  const struct xwindow* const w = cache_get (wnd);
+  if (w == NULL) return false;
+  maximized[0] = w->maximized;
+  return xcb_get_rect (wnd, rect);
+}
+
+/* Placed while not maximized, so that it is restored there */
+static bool xcb_set_placement (HWND const wnd, const RECT* const rect, bool const maximized)
+{
+  struct xwindow* const w = cache_get (wnd);
+  if (w == NULL) return false;
+  const xcb_atom_t vert = atoms[ATOM_NET_WM_STATE_MAXIMIZED_VERT];
+  const xcb_atom_t horz = atoms[ATOM_NET_WM_STATE_MAXIMIZED_HORZ];
+  if (w->maximized) wm_state (w->wnd, false, vert, horz);
+  configure (w->wnd, rect, 0);
+  if (maximized) wm_state (w->wnd, true, vert, horz);
+  w->maximized = maximized;
+  return xcb_flush (conn) > 0;
+}
+
+static size_t xcb_get_monitors (RECT* const rects, size_t const max)
+{
+  /* The screen as a whole: monitors would need RandR */
+  if (max != 0) rects[0] = screen_rect;
+  return 1;
+}
+
+/* -----------------------------------------------------------------------------
+// Hotkeys
+
+// Virtual key codes from `parse_hotkey()` are turned into keysyms and
+// then into whatever key codes the keyboard map has for them. Grabs
+// are repeated with Caps Lock and Num Lock, which would otherwise
+// make the same combination a different one. */
+
+struct xhotkey {
+  int id;
+  xcb_keycode_t code;
+  uint16_t mods;
+  bool used;
+};
+
+static struct xhotkey hotkeys[XCB_HOTKEYS_MAX];
+static xcb_get_keyboard_mapping_reply_t* keymap;
+static xcb_keycode_t keymap_min;
+static void (*hotkey_handler) (int id);
+
+#define LOCK_MODS (XCB_MOD_MASK_LOCK | XCB_MOD_MASK_2)
+static const uint16_t lock_variants[] = {
+  0, XCB_MOD_MASK_LOCK, XCB_MOD_MASK_2, XCB_MOD_MASK_LOCK | XCB_MOD_MASK_2
+};
+
+static void keymap_load (void)
+{
+  const xcb_setup_t* const setup = xcb_get_setup (conn);
+  free (keymap);
+  keymap_min = setup->min_keycode;
+  keymap = xcb_get_keyboard_mapping_reply (conn, xcb_get_keyboard_mapping (conn
+  , setup->min_keycode, setup->max_keycode - setup->min_keycode + 1), NULL);
+}
+
+static xcb_keysym_t vk_to_keysym (UINT const vk)
+{
+  static const struct {UINT vk; xcb_keysym_t sym;} keys[] = {
+    {VK_OEM_1, XK_semicolon}, {VK_OEM_2, XK_slash}, {VK_OEM_3, XK_grave},
+    {VK_OEM_4, XK_bracketleft}, {VK_OEM_5, XK_backslash}, {VK_OEM_6, XK_bracketright},
+    {VK_OEM_7, XK_apostrophe}, {VK_OEM_MINUS, XK_minus}, {VK_OEM_PLUS, XK_equal},
+    {VK_OEM_COMMA, XK_comma}, {VK_OEM_PERIOD, XK_period},
+    {VK_MULTIPLY, XK_KP_Multiply}, {VK_DIVIDE, XK_KP_Divide}, {VK_SUBTRACT, XK_KP_Subtract},
+    {VK_ADD, XK_KP_Add}, {VK_DECIMAL, XK_KP_Decimal},
+    {VK_INSERT, XK_Insert}, {VK_DELETE, XK_Delete}, {VK_HOME, XK_Home}, {VK_END, XK_End},
+    {VK_PRIOR, XK_Prior}, {VK_NEXT, XK_Next}, {VK_BACK, XK_BackSpace}
+  };
+  if (vk >= 'A' && vk <= 'Z') return XK_a + (vk - 'A');
+  if (vk >= '0' && vk <= '9') return XK_0 + (vk - '0');
+  if (vk >= VK_NUMPAD0 && vk <= VK_NUMPAD0 + 9) return XK_KP_0 + (vk - VK_NUMPAD0);
+  if (vk >= VK_F1 && vk <= VK_F1 + 23) return XK_F1 + (vk - VK_F1);
+  for (size_t i = 0; i != numof(keys); ++i) {
+    if (keys[i].vk == vk) return keys[i].sym;
+  }
+  return XK_VoidSymbol;
+}
+
+static xcb_keycode_t keysym_to_keycode (xcb_keysym_t const sym)
+{
+  if (keymap == NULL || sym == XK_VoidSymbol) return 0;
+  const xcb_keysym_t* const syms = xcb_get_keyboard_mapping_keysyms (keymap);
+  const int num = xcb_get_keyboard_mapping_keysyms_length (keymap);
+  const int per = keymap->keysyms_per_keycode;
+  for (int i = 0; i < num; ++i) {
+    if (syms[i] == sym) return (xcb_keycode_t)(keymap_min + i / per);
+  }
+  return 0;
+}
+
+static uint16_t mod_to_mask (UINT const mod)
+{
+  return (mod & MOD_ALT ? XCB_MOD_MASK_1 : 0)
+  | (mod & MOD_CONTROL ? XCB_MOD_MASK_CONTROL : 0)
+  | (mod & MOD_SHIFT ? XCB_MOD_MASK_SHIFT : 0)
+  | (mod & MOD_WIN ? XCB_MOD_MASK_4 : 0);
+}
+
+static void ungrab (const struct xhotkey* const h)
+{
+  for (size_t i = 0; i != numof(lock_variants); ++i) {
+    xcb_ungrab_key (conn, h->code, root, h->mods | lock_variants[i]);
+  }
+}
+
+static bool xcb_unregister_hotkey (HWND const wnd, int const id)
+{
+  for (size_t i = 0; i != XCB_HOTKEYS_MAX; ++i) {
+    if (!hotkeys[i].used || hotkeys[i].id != id) continue;
+    ungrab (hotkeys + i);
+    hotkeys[i].used = false;
+    xcb_flush (conn);
+    return true;
+  }
+  return false;
+}
+
+/* Fails if some other client holds the combination already */
+static bool xcb_register_hotkey (HWND const wnd, int const id, UINT const mod, UINT const code)
+{
+  xcb_unregister_hotkey (wnd, id);
+  size_t slot = 0;
+  while (slot != XCB_HOTKEYS_MAX && hotkeys[slot].used) ++slot;
+  if (slot == XCB_HOTKEYS_MAX) return false;
+  struct xhotkey h = {
+    .id = id,
+    .code = keysym_to_keycode (vk_to_keysym (code)),
+    .mods = mod_to_mask (mod),
+    .used = true
+  };
+  if (h.code == 0) return false;
+
+  /* All variants first, then see if any of them failed */
+  xcb_void_cookie_t c[numof(lock_variants)];
+  for (size_t i = 0; i != numof(lock_variants); ++i) {
+    c[i] = xcb_grab_key_checked (conn, 1, root, h.mods | lock_variants[i], h.code
+    , XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC);
+  }
+  bool ok = true;
+  for (size_t i = 0; i != numof(lock_variants); ++i) {
+    xcb_generic_error_t* const e = xcb_request_check (conn, c[i]);
+    if (e != NULL) ok = false;
+    free (e);
+  }
+  if (!ok) {
+    ungrab (&h);
+    xcb_flush (conn);
+    return false;
+  }
+  hotkeys[slot] = h;
+  return true;
+}
+
+static void hotkey_press (const xcb_key_press_event_t* const ev)
+{
+  const uint16_t mods = ev->state & ~LOCK_MODS;
+  for (size_t i = 0; i != XCB_HOTKEYS_MAX; ++i) {
+    if (hotkeys[i].used && hotkeys[i].code == ev->detail && hotkeys[i].mods == mods) {
+      if (hotkey_handler != NULL) hotkey_handler (hotkeys[i].id);
+      return;
+    }
+  }
+}
+
+/* -----------------------------------------------------------------------------
+// Events, timers and lifetime */
+
+static bool timers[XCB_TIMERS];
+static long long timer_due[XCB_TIMERS];
+static bool watch_windows;
+static bool watch_location;
+
+static bool xcb_set_timer (UINT const id, UINT const ms)
+{
+  if (id >= XCB_TIMERS) return false;
+  timers[id] = true;
+  timer_due[id] = now_ms() + ms;
+  return true;
+}
+
+static void xcb_kill_timer (UINT const id)
+{
+  if (id < XCB_TIMERS) timers[id] = false;
+}
+
+/* Clients tell about their moves, maps and name changes */
+static void client_select (xcb_window_t const wnd, bool const on)
+{
+  const uint32_t mask = on ? XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_PROPERTY_CHANGE : 0;
+  xcb_change_window_attributes (conn, wnd, XCB_CW_EVENT_MASK, &mask);
+}
+
+static bool xcb_watch (enum core_watch const what, bool const on)
+{
+  const bool before = watch_windows || watch_location;
+  if (what == CORE_WATCH_WINDOWS) watch_windows = on;
+  else watch_location = on;
+  const bool after = watch_windows || watch_location;
+  if (before != after && clients_fetch()) {
+    for (size_t i = 0; i != client_num; ++i) client_select (clients[i], after);
+    xcb_flush (conn);
+  }
+  return true;
+}
+
+/* Windows come and go as the window manager lists them */
+static void clients_changed (void)
+{
+  const size_t old_num = client_num;
+  xcb_window_t* const old = arrnew (xcb_window_t, old_num + 1);
+  if (old == NULL) return;
+  if (old_num != 0) arrcopy (old, clients, old_num);
+  clients_valid = false;
+  if (!clients_fetch()) {
+    free (old);
+    return;
+  }
+  /* Both lists are sorted */
+  size_t i = 0, j = 0;
+  while (i != old_num || j != client_num) {
+    if (j == client_num || (i != old_num && old[i] < clients[j])) {
+      if (watch_windows) core_event (CORE_EVENT_DESTROY, hwnd (old[i]));
+      ++i;
+    } else if (i == old_num || clients[j] < old[i]) {
+      client_select (clients[j], true);
+      if (watch_windows) {
+        core_event (CORE_EVENT_CREATE, hwnd (clients[j]));
+        if (xcb_is_visible (hwnd (clients[j]))) core_event (CORE_EVENT_SHOW, hwnd (clients[j]));
+      }
+      ++j;
+    } else {
+      ++i;
+      ++j;
+    }
+  }
+  free (old);
+}
+
+static void event (const xcb_generic_event_t* const ev)
+{
+  const bool watching = watch_windows || watch_location;
+  switch (ev->response_type & ~0x80) {
+  case XCB_KEY_PRESS:
+    hotkey_press ((const xcb_key_press_event_t*)ev);
+    break;
+  case XCB_PROPERTY_NOTIFY: {
+    const xcb_property_notify_event_t* const e = (const xcb_property_notify_event_t*)ev;
+    if (e->window == root) {
+      if (e->atom == atoms[ATOM_NET_CLIENT_LIST] && watching) clients_changed();
+    } else if (e->atom == XCB_ATOM_WM_NAME || e->atom == atoms[ATOM_NET_WM_NAME]) {
+      if (watch_windows) core_event (CORE_EVENT_NAMECHANGE, hwnd (e->window));
+    } else if (e->atom == atoms[ATOM_NET_WM_STATE]) {
+      if (watch_location) core_event (CORE_EVENT_LOCATION, hwnd (e->window));
+    }
+    break;
+  }
+  case XCB_CONFIGURE_NOTIFY: {
+    const xcb_configure_notify_event_t* const e = (const xcb_configure_notify_event_t*)ev;
+    if (e->window == root) {
+      screen_rect.right = e->width;
+      screen_rect.bottom = e->height;
+      core_display_changed();
+    } else if (watch_location) core_event (CORE_EVENT_LOCATION, hwnd (e->window));
+    break;
+  }
+  case XCB_MAP_NOTIFY: {
+    const xcb_map_notify_event_t* const e = (const xcb_map_notify_event_t*)ev;
+    if (watch_windows && e->window != root) core_event (CORE_EVENT_SHOW, hwnd (e->window));
+    break;
+  }
+  case XCB_UNMAP_NOTIFY: {
+    const xcb_unmap_notify_event_t* const e = (const xcb_unmap_notify_event_t*)ev;
+    if (watch_windows && e->window != root) core_event (CORE_EVENT_HIDE, hwnd (e->window));
+    break;
+  }
+  case XCB_MAPPING_NOTIFY:
+    keymap_load();
+    break;
+  }
+}
+
+bool backend_xcb_wait (int const ms, void (*const hotkey) (int id))
+{
+  if (conn == NULL) return false;
+  hotkey_handler = hotkey;
+  xcb_flush (conn);
+
+  /* Until the next timer is due */
+  int timeout = ms;
+  const long long now = now_ms();
+  for (UINT id = 0; id != XCB_TIMERS; ++id) {
+    if (!timers[id]) continue;
+    const long long left = timer_due[id] > now ? timer_due[id] - now : 0;
+    if (timeout < 0 || left < timeout) timeout = (int)left;
+  }
+  xcb_generic_event_t* ev = xcb_poll_for_queued_event (conn);
+  if (ev == NULL) {
+    struct pollfd p = {.fd = xcb_get_file_descriptor (conn), .events = POLLIN};
+    poll (&p, 1, timeout);
+    ev = xcb_poll_for_event (conn);
+  }
+
+  /* Anything known about windows may be out of date now */
+  cache_clear();
+  for (; ev != NULL; ev = xcb_poll_for_event (conn)) {
+    event (ev);
+    free (ev);
+  }
+  if (xcb_connection_has_error (conn)) return false;
+
+  const long long t = now_ms();
+  for (UINT id = 0; id != XCB_TIMERS; ++id) {
+    if (!timers[id] || timer_due[id] > t) continue;
+    timers[id] = false;
+    core_timer (id);
+  }
+  xcb_flush (conn);
+  return true;
+}
+
+HWND backend_xcb_active (void)
+{
+  if (conn == NULL) return NULL;
+  xcb_get_property_reply_t* const r = xcb_get_property_reply (conn
+  , xcb_get_property (conn, 0, root, atoms[ATOM_NET_ACTIVE_WINDOW], XCB_ATOM_WINDOW, 0, 1), NULL);
+  xcb_window_t wnd = XCB_NONE;
+  if (r != NULL && r->format == 32 && xcb_get_property_value_length (r) == 4) {
+    wnd = ((const xcb_window_t*)xcb_get_property_value (r))[0];
+  }
+  free (r);
+  return hwnd (wnd);
+}
+
+static bool xcb_open (void)
+{
+  int num;
+  conn = xcb_connect (NULL, &num);
+  if (xcb_connection_has_error (conn)) {
+    xcb_disconnect (conn);
+    conn = NULL;
+    return false;
+  }
+  xcb_screen_iterator_t it = xcb_setup_roots_iterator (xcb_get_setup (conn));
+  for (; num > 0 && it.rem != 0; --num) xcb_screen_next (&it);
+  const xcb_screen_t* const screen = it.data;
+  root = screen->root;
+  screen_rect = (RECT){0, 0, screen->width_in_pixels, screen->height_in_pixels};
+  screen_dpi = screen->width_in_millimeters != 0
+  ? (UINT)(screen->width_in_pixels * 254 / (screen->width_in_millimeters * 10)) : 96;
+
+  /* All atoms in one round trip */
+  xcb_intern_atom_cookie_t c[ATOM_COUNT];
+  for (int i = 0; i != ATOM_COUNT; ++i) {
+    c[i] = xcb_intern_atom (conn, 0, strlen (atom_names[i]), atom_names[i]);
+  }
+  for (int i = 0; i != ATOM_COUNT; ++i) {
+    xcb_intern_atom_reply_t* const r = xcb_intern_atom_reply (conn, c[i], NULL);
+    atoms[i] = r != NULL ? r->atom : XCB_ATOM_NONE;
+    free (r);
+  }
+
+  /* Fullscreen mode needs a window manager that does it */
+  xcb_get_property_reply_t* const r = xcb_get_property_reply (conn
+  , xcb_get_property (conn, 0, root, atoms[ATOM_NET_SUPPORTED], XCB_ATOM_ATOM, 0, 1024), NULL);
+  fullscreen_supported = false;
+  if (r != NULL && r->format == 32) {
+    const xcb_atom_t* const a = xcb_get_property_value (r);
+    const size_t n = xcb_get_property_value_length (r) / 4;
+    for (size_t i = 0; i != n; ++i) {
+      if (a[i] == atoms[ATOM_NET_WM_STATE_FULLSCREEN]) fullscreen_supported = true;
+    }
+  }
+  free (r);
+
+  keymap_load();
+  const uint32_t mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_PROPERTY_CHANGE;
+  xcb_change_window_attributes (conn, root, XCB_CW_EVENT_MASK, &mask);
+  xcb_flush (conn);
+  return true;
+}
+
+static void xcb_close (void)
+{
+  if (conn == NULL) return;
+  for (size_t i = 0; i != XCB_HOTKEYS_MAX; ++i) {
+    if (hotkeys[i].used) ungrab (hotkeys + i);
+    hotkeys[i].used = false;
+  }
+  xcb_disconnect (conn);
+  conn = NULL;
+  free (keymap);
+  keymap = NULL;
+  free (cache);
+  cache = NULL;
+  cache_size = cache_cap = 0;
+  free (clients);
+  clients = NULL;
+  client_num = client_cap = 0;
+  clients_valid = watch_windows = watch_location = false;
+  memset (timers, 0, sizeof(timers));
+}
+
+static DWORD xcb_current_thread (void)
+{
+  return (DWORD)gettid();
+}
+
+/* ========================================================================== */
+
+const struct backend backend_xcb = {
+  .open              = &xcb_open,
+  .close             = &xcb_close,
+  .current_thread    = &xcb_current_thread,
+  .set_timer         = &xcb_set_timer,
+  .kill_timer        = &xcb_kill_timer,
+  .watch             = &xcb_watch,
+  .get_style         = &xcb_get_style,
+  .set_style         = &xcb_set_style,
+  .get_menu          = &xcb_get_menu,
+  .set_menu          = &xcb_set_menu,
+  .enum_windows      = &xcb_enum_windows,
+  .get_thread        = &xcb_get_thread,
+  .get_process       = &xcb_get_process,
+  .get_class         = &xcb_get_class,
+  .get_title         = &xcb_get_title,
+  .get_exe           = &xcb_get_exe,
+  .is_top_level      = &xcb_is_top_level,
+  .is_visible        = &xcb_is_visible,
+  .is_minimized      = &xcb_is_minimized,
+  .is_maximized      = &xcb_is_maximized,
+  .get_rect          = &xcb_get_rect,
+  .get_dpi           = &xcb_get_dpi,
+  .repaint           = &xcb_repaint,
+  .frame_changed     = &xcb_frame_changed,
+  .dwm_border        = &xcb_dwm_border,
+  .clip_client       = &xcb_clip_client,
+  .get_region        = &xcb_get_region,
+  .unclip            = &xcb_unclip,
+  .free_region       = &xcb_free_region,
+  .veto_attach       = &xcb_veto_attach,
+  .veto_detach       = &xcb_veto_detach,
+  .defer_begin       = &xcb_defer_begin,
+  .defer_pos         = &xcb_defer_pos,
+  .defer_end         = &xcb_defer_end,
+  .set_pos           = &xcb_set_pos,
+  .show              = &xcb_show,
+  .get_placement     = &xcb_get_placement,
+  .set_placement     = &xcb_set_placement,
+  .get_monitors      = &xcb_get_monitors,
+  .register_hotkey   = &xcb_register_hotkey,
+  .unregister_hotkey = &xcb_unregister_hotkey,
+  .file_read         = &posix_file_read,
+  .file_write        = &posix_file_write,
+  .file_replace      = &posix_file_replace,
+  .file_remove       = &posix_file_remove
+};
@@ -0,0 +1,627 @@
+/* =============================================================================
+// BORDERless: benchmarks against the in-memory backend
+//
+// Builds on any system with a C compiler, see `build.sh bench`.
+// Run with no arguments for every case, or name the cases to run.
+// `--latency <ns>` makes every backend call take that long.
+// -------------------------------------------------------------------------- */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <time.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+#include "config.h"
+#include "fake.h"
+#include "hook.h"
+
+/* -----------------------------------------------------------------------------
+// Utilities */
+
+static unsigned latency;
+static uint32_t rng = 2463534242u;
+
+static inline uint32_t rand32 (void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static inline double now_ns (void)
+{
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static const wchar_t* const classes[] = {
+  L"Notepad", L"CabinetWClass", L"Chrome_WidgetWin_1", L"SDL_app",
+  L"Afx:00400000:b", L"ConsoleWindowClass", L"MozillaWindowClass", L"XLMAIN"
+};
+
+/* Window number `i` of a desktop: ten per process */
+static HWND desktop_window (size_t const i)
+{
+  const int x = (int)(i % 64) * 16;
+  return fake_create (&(struct fake_window){
+    .pid = 100 + (DWORD)(i / 10),
+    .style = WS_OVERLAPPEDWINDOW | WS_VISIBLE,
+    .style_ex = WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE,
+    .menu = fake_menu(),
+    .cls = classes[i % numof(classes)],
+    .title = L"Untitled",
+    .rect = {x, x, x + 800, x + 600},
+    .dpi = 96,
+    .visible = true,
+    .top_level = true
+  });
+}
+
+/* Desktop of `num` top-level windows */
+static HWND* desktop (size_t const num)
+{
+  fake_reset();
+  borderless_set_backend (&backend_fake);
+  HWND* const wnds = arrnew (HWND, num);
+  if (wnds == NULL) abort();
+  for (size_t i = 0; i != num; ++i) wnds[i] = desktop_window (i);
+  return wnds;
+}
+
+static bool init (void)
+{
+  return borderless_init (&(struct borderless_config){
+    .size = sizeof(struct borderless_config)
+  });
+}
+
+/* Measured part: with latency, if asked for */
+#define measure(ns, ops, body) do {\
+  fake_latency (latency);\
+  const double t0_ = now_ns();\
+  body;\
+  ns = (now_ns() - t0_) / (double)(ops);\
+  fake_latency (0);\
+} while (0)
+
+static const size_t sizes[] = {10000, 30000, 100000};
+
+/* -----------------------------------------------------------------------------
+// Cases */
+
+/* Hiding and restoring borders of a thousand random windows,
+// then toggling one window back and forth */
+static void bench_toggle (void)
+{
+  wprintf (L"%-8ls %14ls %14ls %14ls\n", L"windows", L"hide ns/op", L"restore ns/op"
+  , L"toggle ns/op");
+  for (size_t s = 0; s != numof(sizes); ++s) {
+    const size_t num = sizes[s];
+    HWND* const wnds = desktop (num);
+    if (!init()) abort();
+    enum {OPS = 1000, TOGGLES = 20000};
+    HWND picked[OPS];
+    for (size_t i = 0; i != OPS; ++i) picked[i] = wnds[(i * 7919) % num];
+
+    double hide, restore, toggle;
+    measure (hide, OPS, for (size_t i = 0; i != OPS; ++i) borderless_border (picked[i], BORDERLESS_HIDE));
+    measure (restore, OPS, for (size_t i = 0; i != OPS; ++i) borderless_border (picked[i], BORDERLESS_RESTORE));
+    HWND const wnd = wnds[num / 2];
+    measure (toggle, TOGGLES, for (size_t i = 0; i != TOGGLES; ++i) borderless_border (wnd, BORDERLESS_TOGGLE));
+
+    wprintf (L"%-8zu %14.0f %14.0f %14.0f\n", num, hide, restore, toggle);
+    borderless_shutdown();
+    free (wnds);
+  }
+}
+
+/* Tracked state is confined to one thread, so readers queue up there
+// rather than run in parallel: lookups (half of them hits) against a
+// thousand tracked windows, and what a hide or restore waits behind
+// 1 to 16 lookups asked for just before it */
+static void bench_registry (void)
+{
+  enum {NUM = 10000, TRACKED = 1000, READS = 100000, WRITES = 20000};
+  HWND* const wnds = desktop (NUM);
+  if (!init()) abort();
+  for (size_t i = 0; i != TRACKED; ++i) borderless_border (wnds[i * 2], BORDERLESS_HIDE);
+
+  double read, write;
+  struct borderless_state state;
+  size_t hits = 0;
+  measure (read, READS, for (size_t i = 0; i != READS; ++i) {
+    hits += borderless_get_state (wnds[rand32() % (TRACKED * 2)], &state);
+  });
+  measure (write, WRITES, for (size_t i = 0; i != WRITES; ++i) {
+    borderless_border (wnds[(rand32() % TRACKED) * 2], BORDERLESS_TOGGLE);
+  });
+  wprintf (L"%.1f M lookups/s (%.0f ns), %.0f ns per write\n", 1e3 / read, read, write);
+
+  wprintf (L"%-8ls %14ls\n", L"readers", L"write wait ns");
+  for (size_t readers = 1; readers <= 16; readers *= 2) {
+    double wait;
+    measure (wait, WRITES, for (size_t i = 0; i != WRITES; ++i) {
+      for (size_t r = 0; r != readers; ++r) {
+        hits += borderless_get_state (wnds[rand32() % (TRACKED * 2)], &state);
+      }
+      borderless_border (wnds[(rand32() % TRACKED) * 2], BORDERLESS_TOGGLE);
+    });
+    wprintf (L"%-8zu %14.0f\n", readers, wait);
+  }
+  (void)hits;
+  borderless_shutdown();
+  free (wnds);
+}
+
+static bool watch_fails (enum core_watch const what, bool const on)
+{
+  return !on;
+}
+
+/* Menu restore of an untracked window is all top-level check:
+// from the inventory, and by enumeration when there is none */
+static void bench_top_level (void)
+{
+  wprintf (L"%-8ls %14ls %14ls\n", L"windows", L"inventory ns", L"enum ns");
+  for (size_t s = 0; s != numof(sizes); ++s) {
+    const size_t num = sizes[s];
+    HWND* const wnds = desktop (num);
+    enum {OPS = 100000, ENUM_OPS = 200};
+    double inv, en;
+
+    if (!init()) abort();
+    measure (inv, OPS, for (size_t i = 0; i != OPS; ++i) {
+      borderless_menu (wnds[rand32() % num], BORDERLESS_RESTORE);
+    });
+    borderless_shutdown();
+
+    struct backend no_watch = backend_fake;
+    no_watch.watch = &watch_fails;
+    borderless_set_backend (&no_watch);
+    if (!init()) abort();
+    measure (en, ENUM_OPS, for (size_t i = 0; i != ENUM_OPS; ++i) {
+      borderless_menu (wnds[rand32() % num], BORDERLESS_RESTORE);
+    });
+    borderless_shutdown();
+
+    wprintf (L"%-8zu %14.0f %14.0f\n", num, inv, en);
+    free (wnds);
+  }
+}
+
+/* Windows coming and going all the time, with queries in between:
+// what keeping the inventory and its indices current costs, and
+// what the indices save over looking at every window */
+static void bench_churn (void)
+{
+  wprintf (L"%-8ls %12ls %12ls %12ls %12ls %12ls  %ls\n", L"windows", L"churn ns/op"
+  , L"pid ns/op", L"class ns/op", L"both ns/op", L"scan ns/op", L"inventory");
+  for (size_t s = 0; s != numof(sizes); ++s) {
+    const size_t num = sizes[s];
+    HWND* const wnds = desktop (num);
+    if (!init()) abort();
+    enum {CHURN = 20000, QUERIES = 20000, SCANS = 200};
+    HWND out[16];
+    size_t next = num, found = 0;
+    double churn, pid, cls, both, scan;
+
+    /* Destroyed and created in a burst, each one a window event */
+    measure (churn, CHURN, for (size_t i = 0; i != CHURN; ++i) {
+      const size_t k = rand32() % num;
+      fake_destroy (wnds[k]);
+      wnds[k] = desktop_window (next++);
+    });
+    /* Processes of the windows still there */
+    #define query(ns, ops, p, c) measure (ns, ops, for (size_t i = 0; i != (ops); ++i) {\
+      const struct fake_window* const w_ = fake_get (wnds[rand32() % num]);\
+      found += borderless_windows ((p) ? w_->pid : 0, (c) ? w_->cls : NULL, false, out\
+      , numof(out));\
+    })
+    query (pid, QUERIES, true, false);
+    query (cls, QUERIES, false, true);
+    query (both, QUERIES, true, true);
+    #undef query
+    /* Every window, the way each query went before the indices */
+    measure (scan, SCANS, for (size_t i = 0; i != SCANS; ++i) {
+      found += borderless_windows (0, NULL, false, NULL, 0);
+    });
+
+    wprintf (L"%-8zu %12.0f %12.0f %12.0f %12.0f %12.0f  %ls\n", num, churn, pid, cls, both
+    , scan, core_inventory_check() ? L"in sync" : L"OUT OF SYNC");
+    (void)found;
+    borderless_shutdown();
+    free (wnds);
+  }
+}
+
+/* Automatic fullscreen with windows which declined it, alive and then
+// destroyed: what a batch of fullscreen checks costs either way */
+static void bench_fullscreen (void)
+{
+  static const size_t declined[] = {0, 100, 1000};
+  wprintf (L"%-9ls %14ls %14ls %14ls %14ls\n", L"declined", L"alive ns", L"alive calls"
+  , L"dead ns", L"dead calls");
+  const RECT full = {0, 0, 1920, 1080};
+  for (size_t d = 0; d != numof(declined); ++d) {
+    enum {NUM = 2000, MOVED = 100, BATCHES = 200};
+    HWND* const wnds = desktop (NUM);
+    if (!borderless_init (&(struct borderless_config){
+      .size = sizeof(struct borderless_config),
+      .fullscreen = true
+    })) abort();
+    fake_run_timers();
+    /* Fullscreen, then the border restored by hand */
+    for (size_t i = 0; i != declined[d]; ++i) fake_move (wnds[i], &full, 96);
+    fake_run_timers();
+    for (size_t i = 0; i != declined[d]; ++i) borderless_border (wnds[i], BORDERLESS_RESTORE);
+
+    /* Other windows moving about, a batch at a time */
+    double ns[2], calls[2];
+    for (int dead = 0; dead != 2; ++dead) {
+      if (dead) for (size_t i = 0; i != declined[d]; ++i) fake_destroy (wnds[i]);
+      const size_t calls0 = fake_stats.calls;
+      measure (ns[dead], BATCHES, for (size_t b = 0; b != BATCHES; ++b) {
+        for (size_t i = 0; i != MOVED; ++i) {
+          HWND const wnd = wnds[NUM - 1 - (b * MOVED + i) % (NUM - declined[d])];
+          const struct fake_window* const w = fake_get (wnd);
+          fake_move (wnd, &w->rect, 96);
+        }
+        fake_run_timers();
+      });
+      calls[dead] = (double)(fake_stats.calls - calls0) / BATCHES;
+    }
+
+    wprintf (L"%-9zu %14.0f %14.0f %14.0f %14.0f\n", declined[d], ns[0], calls[0]
+    , ns[1], calls[1]);
+    borderless_shutdown();
+    free (wnds);
+  }
+}
+
+/* Hiding and restoring with each mode: time, and the work
+// asked of the window manager per hide/restore pair */
+static void bench_modes (void)
+{
+  static const wchar_t* const names[] = {L"mask", L"dwm", L"region"};
+  wprintf (L"%-8ls %10ls %8ls %8ls %8ls %8ls %8ls\n", L"mode", L"ns/pair", L"calls"
+  , L"frames", L"repaints", L"dwm", L"recomp");
+  enum {NUM = 1000};
+  for (int m = BORDERLESS_MODE_MASK; m <= BORDERLESS_MODE_REGION; ++m) {
+    HWND* const wnds = desktop (NUM);
+    if (!borderless_init (&(struct borderless_config){
+      .size = sizeof(struct borderless_config),
+      .mode = m
+    })) abort();
+
+    const struct fake_stats before = fake_stats;
+    double pair;
+    measure (pair, NUM, for (size_t i = 0; i != NUM; ++i) {
+      borderless_border (wnds[i], BORDERLESS_HIDE);
+      borderless_border (wnds[i], BORDERLESS_RESTORE);
+    });
+    #define per_pair(field) ((fake_stats.field - before.field) / (double)NUM)
+    wprintf (L"%-8ls %10.0f %8.1f %8.1f %8.1f %8.1f %8.1f\n", names[m], pair
+    , per_pair (calls), per_pair (frame_changes), per_pair (repaints)
+    , per_pair (dwm_calls), per_pair (recompositions));
+    #undef per_pair
+    borderless_shutdown();
+    free (wnds);
+  }
+}
+
+/* What a launcher pays per call: one window, all windows of a
+// process (ten on this desktop), and the same ten as a batch */
+static void bench_api (void)
+{
+  wprintf (L"%-8ls %12ls %8ls %12ls %8ls %12ls %8ls\n", L"windows", L"border ns"
+  , L"calls", L"pid ns", L"calls", L"batch ns", L"calls");
+  for (size_t s = 0; s != numof(sizes); ++s) {
+    enum {OPS = 2000, PROCS = 100};
+    const size_t num = sizes[s];
+    HWND* const wnds = desktop (num);
+    if (!init()) abort();
+
+    double border, pid, batch;
+    size_t calls0 = fake_stats.calls;
+    measure (border, OPS, for (size_t i = 0; i != OPS; ++i) {
+      borderless_border (wnds[(i * 7919) % num], BORDERLESS_TOGGLE);
+    });
+    const double border_calls = (double)(fake_stats.calls - calls0) / OPS;
+    calls0 = fake_stats.calls;
+    measure (pid, OPS, for (size_t i = 0; i != OPS; ++i) {
+      borderless_border_pid (100 + (DWORD)(i % PROCS), BORDERLESS_TOGGLE);
+    });
+    const double pid_calls = (double)(fake_stats.calls - calls0) / OPS;
+    /* Processes as above */
+    struct borderless_op ops[PROCS * 10];
+    for (size_t i = 0; i != numof(ops); ++i) {
+      ops[i] = (struct borderless_op){
+        .wnd = wnds[i],
+        .border = BORDERLESS_TOGGLE,
+        .mode = -1
+      };
+    }
+    calls0 = fake_stats.calls;
+    measure (batch, OPS, for (size_t i = 0; i != OPS; ++i) {
+      borderless_batch (ops + (i % PROCS) * 10, 10);
+    });
+
+    wprintf (L"%-8zu %12.0f %8.1f %12.0f %8.1f %12.0f %8.1f\n", num, border, border_calls
+    , pid, pid_calls, batch, (double)(fake_stats.calls - calls0) / OPS);
+    borderless_shutdown();
+    free (wnds);
+  }
+}
+
+/* A layout: border and menu hidden and every window moved, then
+// all restored, in one batch and one window at a time */
+static void bench_batch (void)
+{
+  static const size_t nums[] = {4, 16, 64};
+  wprintf (L"%-8ls %12ls %8ls %8ls %12ls %8ls %8ls\n", L"windows", L"batch ns", L"recomp"
+  , L"frames", L"single ns", L"recomp", L"frames");
+  for (size_t n = 0; n != numof(nums); ++n) {
+    enum {ROUNDS = 2000};
+    const size_t num = nums[n];
+    HWND* const wnds = desktop (num);
+    struct borderless_op* const apply = arrnew (struct borderless_op, num);
+    struct borderless_op* const undo = arrnew (struct borderless_op, num);
+    if (apply == NULL || undo == NULL || !init()) abort();
+    for (size_t i = 0; i != num; ++i) {
+      const int x = (int)(i % 8) * 240, y = (int)(i / 8) * 135;
+      apply[i] = (struct borderless_op){
+        .wnd = wnds[i],
+        .border = BORDERLESS_HIDE,
+        .menu = BORDERLESS_HIDE,
+        .mode = -1,
+        .place = BORDERLESS_PLACE_RECT,
+        .rect = {x, y, x + 240, y + 135}
+      };
+      undo[i] = (struct borderless_op){
+        .wnd = wnds[i],
+        .border = BORDERLESS_RESTORE,
+        .menu = BORDERLESS_RESTORE
+      };
+    }
+
+    double batch, single;
+    struct fake_stats before = fake_stats;
+    measure (batch, ROUNDS, for (size_t r = 0; r != ROUNDS; ++r) {
+      borderless_batch (apply, num);
+      borderless_batch (undo, num);
+    });
+    #define per_round(field) ((fake_stats.field - before.field) / (double)ROUNDS)
+    const double batch_recomp = per_round (recompositions);
+    const double batch_frames = per_round (frame_changes);
+    before = fake_stats;
+    measure (single, ROUNDS, for (size_t r = 0; r != ROUNDS; ++r) {
+      for (size_t i = 0; i != num; ++i) {
+        borderless_border (wnds[i], BORDERLESS_HIDE);
+        borderless_menu (wnds[i], BORDERLESS_HIDE);
+        backend->set_pos (wnds[i], &apply[i].rect, SWP_NOZORDER | SWP_NOACTIVATE);
+      }
+      for (size_t i = 0; i != num; ++i) {
+        borderless_border (wnds[i], BORDERLESS_RESTORE);
+        borderless_menu (wnds[i], BORDERLESS_RESTORE);
+      }
+    });
+
+    wprintf (L"%-8zu %12.0f %8.1f %8.1f %12.0f %8.1f %8.1f\n", num, batch, batch_recomp
+    , batch_frames, single, per_round (recompositions), per_round (frame_changes));
+    #undef per_round
+    borderless_shutdown();
+    free (apply);
+    free (undo);
+    free (wnds);
+  }
+}
+
+/* Display change with 50 borderless windows: the pass that runs
+// once things settle, with every frame rebuilt and with none */
+static void bench_reapply (void)
+{
+  enum {NUM = 50, OPS = 2000};
+  HWND* const wnds = desktop (NUM);
+  if (!init()) abort();
+  for (size_t i = 0; i != NUM; ++i) {
+    borderless_border (wnds[i], BORDERLESS_HIDE);
+    borderless_menu (wnds[i], BORDERLESS_HIDE);
+  }
+
+  double all, none;
+  struct fake_stats before = fake_stats;
+  measure (all, OPS, for (size_t n = 0; n != OPS; ++n) {
+    for (size_t i = 0; i != NUM; ++i) {
+      struct fake_window* const w = fake_get (wnds[i]);
+      w->style |= WS_OVERLAPPEDWINDOW;
+      w->menu = fake_menu();
+    }
+    core_display_changed();
+    fake_run_timers();
+  });
+  const size_t batches = fake_stats.defer_batches - before.defer_batches;
+  const size_t frames = fake_stats.frame_changes - before.frame_changes;
+  measure (none, OPS, for (size_t n = 0; n != OPS; ++n) {
+    core_display_changed();
+    fake_run_timers();
+  });
+
+  wprintf (L"%d windows: all drifted %.0f ns/pass (%.1f frames, %.1f batches),"
+  L" none drifted %.0f ns/pass\n", NUM, all, frames / (double)OPS
+  , batches / (double)OPS, none);
+  borderless_shutdown();
+  free (wnds);
+}
+
+/* Compatibility lookup with the user table full: a hit on its last
+// entry, and a miss which goes through the built-in table as well */
+static void bench_compat (void)
+{
+  enum {OPS = 1000000};
+  fake_reset();
+  borderless_set_backend (&backend_fake);
+  wchar_t line[BORDERLESS_COMPAT_LINE_MAX];
+  for (int i = 0; i != BORDERLESS_COMPAT_MAX; ++i) {
+    swprintf (line, numof(line), L"UserClass%d 0xcf0000 0x20301 move", i);
+    if (!borderless_compat_add (line)) abort();
+  }
+  static wchar_t last[32];
+  swprintf (last, numof(last), L"UserClass%d", BORDERLESS_COMPAT_MAX - 1);
+  struct fake_window w = {
+    .pid = 100,
+    .style = WS_OVERLAPPEDWINDOW | WS_VISIBLE,
+    .style_ex = WS_EX_WINDOWEDGE,
+    .cls = last,
+    .title = L"Untitled",
+    .rect = {0, 0, 800, 600},
+    .dpi = 96,
+    .visible = true,
+    .top_level = true
+  };
+  HWND const hit = fake_create (&w);
+  w.cls = L"NoSuchClass";
+  HWND const miss = fake_create (&w);
+  if (!init()) abort();
+
+  double h, m;
+  size_t found = 0;
+  measure (h, OPS, for (size_t i = 0; i != OPS; ++i) found += core_compat_match (hit));
+  measure (m, OPS, for (size_t i = 0; i != OPS; ++i) found += core_compat_match (miss));
+  wprintf (L"%d user rules: hit on the last %.1f ns, miss %.1f ns\n"
+  , BORDERLESS_COMPAT_MAX, h, m);
+  if (found != OPS) abort();
+  borderless_compat_clear();
+  borderless_shutdown();
+}
+
+/* Looking for free hotkeys once registration fails: each
+// candidate is registered and unregistered again */
+static void bench_hotkeys (void)
+{
+  enum {OPS = 200};
+  fake_reset();
+  borderless_set_backend (&backend_fake);
+  HWND const wnd = fake_create (&(struct fake_window){.cls = L"STATIC", .dpi = 96});
+  for (UINT code = 'A'; code <= 'Z'; code += 3) fake_hotkey_taken (MOD_CONTROL | MOD_ALT, code);
+  const struct hotkey want = {.ctrl = 1, .alt = 1, .code = 'D', .set = true};
+  struct hotkey alt[HOTKEY_SUGGEST];
+
+  const size_t calls = fake_stats.calls;
+  hotkey_scan (wnd, &want);
+  const size_t per_scan = fake_stats.calls - calls;
+  double scan, suggest;
+  size_t num = 0;
+  measure (scan, OPS, for (size_t i = 0; i != OPS; ++i) hotkey_scan (wnd, &want));
+  measure (suggest, OPS, for (size_t i = 0; i != OPS; ++i) num = hotkey_suggest (&want, alt));
+  wprintf (L"scan %.0f ns (%zu backend calls), suggest %.0f ns (%zu found)\n"
+  , scan, per_scan, suggest, num);
+}
+
+/* Full configuration file with every compatibility rule taken */
+static void bench_config (void)
+{
+  static wchar_t text[CONFIG_SIZE];
+  fake_reset();
+  borderless_set_backend (&backend_fake);
+  borderless_compat_clear();
+  for (int i = 0; i != BORDERLESS_COMPAT_MAX; ++i) {
+    wchar_t line[BORDERLESS_COMPAT_LINE_MAX];
+    swprintf (line, numof(line), L"App%dClass* 0xcf0000 0x20301 frame%ls", i, i & 1 ? L" menu" : L"");
+    borderless_compat_add (line);
+  }
+  hkey_border = hkey_border_def;
+  hkey_menu = hkey_menu_def;
+  config_format (text);
+
+  enum {OPS = 20000};
+  double parse, format;
+  measure (parse, OPS, for (size_t i = 0; i != OPS; ++i) config_parse (text));
+  measure (format, OPS, for (size_t i = 0; i != OPS; ++i) config_format (text));
+  wprintf (L"config of %zu chars: parse %.0f ns/op, format %.0f ns/op\n"
+  , wcslen (text), parse, format);
+}
+
+/* What the hook module adds to every message sent to a thread with
+// a hooked window: the table lookup, which misses for all other
+// windows and all other messages. Worst case hit is the last entry. */
+static void bench_hook (void)
+{
+  static const LONG used[] = {1, 8, HOOK_MAX};
+  wprintf (L"%-8ls %14ls %14ls\n", L"hooked", L"miss ns/msg", L"hit ns/msg");
+  static struct hook_table table;
+  for (size_t u = 0; u != numof(used); ++u) {
+    objzero (&table);
+    table.used = used[u];
+    for (LONG i = 0; i != used[u]; ++i) table.entries[i].wnd = (i + 1) * 4;
+    enum {MSGS = 10000000};
+    HWND const miss = (HWND)(ULONG_PTR)0x10000;
+    HWND const hit = (HWND)(ULONG_PTR)(used[u] * 4);
+    size_t found = 0;
+    double m, h;
+    measure (m, MSGS, for (size_t i = 0; i != MSGS; ++i) {
+      found += hook_table_find (&table, miss) != NULL;
+      __asm__ volatile ("" ::: "memory");
+    });
+    measure (h, MSGS, for (size_t i = 0; i != MSGS; ++i) {
+      found += hook_table_find (&table, hit) != NULL;
+      __asm__ volatile ("" ::: "memory");
+    });
+    wprintf (L"%-8ld %14.2f %14.2f\n", (long)used[u], m, h);
+    (void)found;
+  }
+}
+
+/* ========================================================================== */
+
+struct bench_case {
+  const char* name;
+  void (*run) (void);
+};
+
+static const struct bench_case cases[] = {
+  {"toggle",    &bench_toggle},
+  {"top-level", &bench_top_level},
+  {"churn",     &bench_churn},
+  {"registry",  &bench_registry},
+  {"fullscreen", &bench_fullscreen},
+  {"modes",     &bench_modes},
+  {"api",       &bench_api},
+  {"batch",     &bench_batch},
+  {"reapply",   &bench_reapply},
+  {"hotkeys",   &bench_hotkeys},
+  {"compat",    &bench_compat},
+  {"config",    &bench_config},
+  {"hook",      &bench_hook}
+};
+
+int main (int const argc, char** const argv)
+{
+  bool all = true;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp (argv[i], "--latency") == 0 && i + 1 < argc) latency = atoi (argv[++i]);
+    else all = false;
+  }
+  if (latency != 0) wprintf (L"latency: %u ns per backend call\n", latency);
+
+  for (size_t c = 0; c != numof(cases); ++c) {
+    bool run = all;
+    for (int i = 1; i < argc && !run; ++i) run = strcmp (argv[i], cases[c].name) == 0;
+    if (!run) continue;
+    wprintf (L"\n== %s\n", cases[c].name);
+    cases[c].run();
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+/* =============================================================================
+// BORDERless: configuration file survives being killed mid-save
+//
+// A child process keeps saving two different configurations in turn
+// and gets killed at random points. Whatever is left on disk must
+// then parse as one of the two, never as a mix or as nothing.
+// Builds on POSIX systems, see `build.sh bench`.
+// `crash [rounds]`, 500 rounds by default.
+// -------------------------------------------------------------------------- */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+#include "config.h"
+#include "fake.h"
+
+static wchar_t texts[2][CONFIG_SIZE];
+static wchar_t result[CONFIG_SIZE];
+
+/* The two differ in every setting and in length */
+static void make_texts (void)
+{
+  for (int t = 0; t != 2; ++t) {
+    borderless_compat_clear();
+    const int rules = t == 0 ? 4 : BORDERLESS_COMPAT_MAX;
+    for (int i = 0; i != rules; ++i) {
+      wchar_t line[BORDERLESS_COMPAT_LINE_MAX];
+      swprintf (line, numof(line), L"Config%dRule%dClass* 0xcf0000 0x20301 frame", t, i);
+      borderless_compat_add (line);
+    }
+    show_coffee = t == 0;
+    auto_fullscreen = t != 0;
+    style_mask = t == 0 ? 0xcf0000 : 0xc40000;
+    hkey_border = hkey_border_def;
+    hkey_menu = hkey_menu_def;
+    hkey_menu.disabled = t != 0;
+    config_format (texts[t]);
+  }
+}
+
+/* Which of the two is on disk: -1 for neither */
+static int check (const wchar_t* const path)
+{
+  wchar_t* const text = backend->file_read (path);
+  if (text == NULL) return -1;
+  config_parse (text);
+  free (text);
+  config_format (result);
+  for (int t = 0; t != 2; ++t) {
+    if (wcscmp (result, texts[t]) == 0) return t;
+  }
+  return -1;
+}
+
+int main (int const argc, char** const argv)
+{
+  const int rounds = argc > 1 ? atoi (argv[1]) : 500;
+  borderless_set_backend (&backend_fake);
+  make_texts();
+
+  char dir[] = "/tmp/borderless-crash-XXXXXX";
+  if (mkdtemp (dir) == NULL) return EXIT_FAILURE;
+  wchar_t path[256];
+  swprintf (path, numof(path), L"%s/borderless.cfg", dir);
+  if (!config_write (path, texts[0])) return EXIT_FAILURE;
+
+  srand (12345);
+  int seen[2] = {0, 0};
+  int failed = 0;
+  for (int r = 0; r != rounds; ++r) {
+    const pid_t child = fork();
+    if (child == -1) return EXIT_FAILURE;
+    if (child == 0) {
+      for (unsigned i = 1;; ++i) config_write (path, texts[i & 1]);
+    }
+    usleep (rand() % 5000);
+    kill (child, SIGKILL);
+    waitpid (child, NULL, 0);
+
+    const int t = check (path);
+    if (t < 0) {
+      wprintf (L"round %d: configuration is neither old nor new\n", r);
+      ++failed;
+      /* Carry on from a known state */
+      config_write (path, texts[0]);
+    } else ++seen[t];
+  }
+
+  wchar_t tmp[256];
+  swprintf (tmp, numof(tmp), L"%ls.tmp", path);
+  backend->file_remove (tmp);
+  backend->file_remove (path);
+  rmdir (dir);
+
+  wprintf (L"%d rounds: %d first, %d second, %d broken\n", rounds, seen[0], seen[1], failed);
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
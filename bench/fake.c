@@ -0,0 +1,721 @@
+/* =============================================================================
+// BORDERless: in-memory backend for benchmarks
+//
+// See `fake.h`. Single-threaded like the UI thread it stands in for.
+// -------------------------------------------------------------------------- */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <time.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+#include "fake.h"
+
+/* -----------------------------------------------------------------------------
+// Backend variables */
+#define FAKE_UI_THREAD 1
+#define FAKE_TIMERS 8
+#define FAKE_MONITORS_MAX 16
+#define FAKE_HOTKEYS_MAX 64
+
+struct slot {
+  struct fake_window w;
+  DWORD thread; // 0 if free
+  RECT normal;  // restored placement of maximized windows
+  bool clipped;
+  bool dwm;
+  size_t next_free;
+};
+
+static size_t slot_num;
+static size_t slot_cap;
+static struct slot* slots;
+static size_t free_head = SIZE_MAX; // recycled first, like Windows does
+static DWORD next_thread = 1000;
+static ULONG_PTR next_menu = 1;
+
+static bool watch_windows;
+static bool watch_location;
+static bool timers[FAKE_TIMERS];
+
+static size_t monitor_num = 1;
+static RECT monitors[FAKE_MONITORS_MAX] = {{0, 0, 1920, 1080}};
+
+static bool hotkey_taken[16][256];
+struct hotkey_reg {
+  HWND wnd;
+  int id;
+  UINT mod;
+  UINT code;
+};
+static struct hotkey_reg hotkeys[FAKE_HOTKEYS_MAX];
+
+static unsigned latency;
+
+struct fake_stats fake_stats;
+
+/* -----------------------------------------------------------------------------
+// Utilities */
+
+static inline long long now_ns (void)
+{
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ll + t.tv_nsec;
+}
+
+/* Every call goes through here */
+static inline void call (void)
+{
+  ++fake_stats.calls;
+  if (latency == 0) return;
+  const long long end = now_ns() + latency;
+  while (now_ns() < end);
+}
+
+static inline HWND slot_wnd (size_t const i)
+{
+  return (HWND)(ULONG_PTR)((i + 1) * 4);
+}
+
+static struct slot* slot_get (HWND const wnd)
+{
+  const ULONG_PTR h = (ULONG_PTR)wnd;
+  if (h == 0 || (h & 3) != 0 || h / 4 > slot_num) return NULL;
+  struct slot* const s = slots + h / 4 - 1;
+  return s->thread != 0 ? s : NULL;
+}
+
+static inline int mod_index (UINT const mod)
+{
+  return mod & (MOD_ALT | MOD_CONTROL | MOD_SHIFT | MOD_WIN);
+}
+
+/* -----------------------------------------------------------------------------
+// Windows */
+
+static LONG fake_get_style (HWND const wnd, int const index)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  if (s == NULL) return 0;
+  return index == GWL_STYLE ? s->w.style : s->w.style_ex;
+}
+
+static LONG fake_set_style (HWND const wnd, int const index, LONG const style)
+{
+  call();
+  struct slot* const s = slot_get (wnd);
+  if (s == NULL) return 0;
+  ++fake_stats.style_writes;
+  LONG* const p = index == GWL_STYLE ? &s->w.style : &s->w.style_ex;
+  const LONG old = p[0];
+  p[0] = style;
+  return old;
+}
+
+static HMENU fake_get_menu (HWND const wnd)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL ? s->w.menu : NULL;
+}
+
+static bool fake_set_menu (HWND const wnd, HMENU const menu)
+{
+  call();
+  struct slot* const s = slot_get (wnd);
+  if (s == NULL) return false;
+  s->w.menu = menu;
+  ++fake_stats.frame_changes;
+  ++fake_stats.recompositions;
+  return true;
+}
+
+static bool fake_enum_windows (backend_enum_fn* const fn, void* const param)
+{
+  call();
+  for (size_t i = 0; i != slot_num; ++i) {
+    call();
+    if (slots[i].thread != 0 && slots[i].w.top_level && !fn (slot_wnd (i), param)) break;
+  }
+  return true;
+}
+
+static DWORD fake_get_thread (HWND const wnd)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL ? s->thread : 0;
+}
+
+static DWORD fake_get_process (HWND const wnd)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL ? s->w.pid : 0;
+}
+
+static int copy_str (const wchar_t* const src, wchar_t* const dst, int const size)
+{
+  if (size <= 0) return 0;
+  const size_t len = src != NULL ? wcslen (src) : 0;
+  const size_t num = len < (size_t)size - 1 ? len : (size_t)size - 1;
+  if (num != 0) wmemcpy (dst, src, num);
+  dst[num] = '\0';
+  return num;
+}
+
+static int fake_get_class (HWND const wnd, wchar_t* const cls, int const size)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL ? copy_str (s->w.cls, cls, size) : 0;
+}
+
+static int fake_get_title (HWND const wnd, wchar_t* const title, int const size)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL ? copy_str (s->w.title, title, size) : 0;
+}
+
+static bool fake_get_exe (DWORD const pid, wchar_t* const path, size_t const size)
+{
+  call();
+  return swprintf (path, size, L"C:\\apps\\app%lu.exe", (unsigned long)pid) > 0;
+}
+
+static bool fake_is_top_level (HWND const wnd)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL && s->w.top_level;
+}
+
+static bool fake_is_visible (HWND const wnd)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL && s->w.visible;
+}
+
+static bool fake_is_minimized (HWND const wnd)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL && s->w.minimized;
+}
+
+static bool fake_is_maximized (HWND const wnd)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL && s->w.maximized;
+}
+
+static bool fake_get_rect (HWND const wnd, RECT* const rect)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  if (s == NULL) return false;
+  rect[0] = s->w.rect;
+  return true;
+}
+
+static UINT fake_get_dpi (HWND const wnd)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  return s != NULL ? s->w.dpi : 0;
+}
+
+static void location_changed (HWND const wnd)
+{
+  if (watch_location) core_event (CORE_EVENT_LOCATION, wnd);
+}
+
+/* Shrinks the window by a pixel and grows it back */
+static void fake_repaint (HWND const wnd)
+{
+  call();
+  if (slot_get (wnd) == NULL) return;
+  ++fake_stats.repaints;
+  fake_stats.recompositions += 2;
+  location_changed (wnd);
+  location_changed (wnd);
+}
+
+static void fake_frame_changed (HWND const wnd)
+{
+  call();
+  if (slot_get (wnd) == NULL) return;
+  ++fake_stats.frame_changes;
+  ++fake_stats.recompositions;
+}
+
+/* -----------------------------------------------------------------------------
+// Ways of hiding borders other than styles */
+
+static bool fake_dwm_border (HWND const wnd, bool const hide)
+{
+  call();
+  struct slot* const s = slot_get (wnd);
+  if (s == NULL) return false;
+  ++fake_stats.dwm_calls;
+  ++fake_stats.recompositions;
+  s->dwm = hide;
+  return true;
+}
+
+static bool fake_clip_client (HWND const wnd)
+{
+  call();
+  struct slot* const s = slot_get (wnd);
+  if (s == NULL) return false;
+  /* A new region replaces the old one */
+  if (!s->clipped) ++fake_stats.regions;
+  s->clipped = true;
+  s->w.region = false;
+  ++fake_stats.recompositions;
+  return true;
+}
+
+/* Saved regions are counted until given back */
+static void* fake_get_region (HWND const wnd)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  if (s == NULL || !s->w.region) return NULL;
+  void* const region = malloc (1);
+  if (region != NULL) ++fake_stats.regions;
+  return region;
+}
+
+static void fake_free_region (void* const region)
+{
+  call();
+  free (region);
+  --fake_stats.regions;
+}
+
+static void fake_unclip (HWND const wnd, void* const region)
+{
+  call();
+  struct slot* const s = slot_get (wnd);
+  if (region != NULL) {
+    free (region);
+    --fake_stats.regions;
+  }
+  if (s == NULL) return;
+  if (s->clipped) --fake_stats.regions;
+  s->clipped = false;
+  s->w.region = region != NULL;
+  ++fake_stats.recompositions;
+}
+
+/* -----------------------------------------------------------------------------
+// Hook module */
+
+static void* fake_veto_attach (HWND const wnd, DWORD const thread
+, LONG const mask, LONG const mask_ex)
+{
+  call();
+  if (slot_get (wnd) == NULL) return NULL;
+  ++fake_stats.hooks;
+  return (void*)wnd;
+}
+
+static long fake_veto_detach (void* const veto)
+{
+  call();
+  --fake_stats.hooks;
+  return 0;
+}
+
+/* -----------------------------------------------------------------------------
+// Placement */
+
+static void place (struct slot* const s, HWND const wnd, const RECT* const rect
+, UINT const flags)
+{
+  ++fake_stats.moves;
+  if (flags & SWP_FRAMECHANGED) ++fake_stats.frame_changes;
+  if ((flags & (SWP_NOMOVE | SWP_NOSIZE)) == (SWP_NOMOVE | SWP_NOSIZE)) return;
+  s->w.rect = rect[0];
+  if (!s->w.maximized) s->normal = rect[0];
+  location_changed (wnd);
+}
+
+static HDWP fake_defer_begin (int const num)
+{
+  call();
+  return (HDWP)&fake_stats;
+}
+
+static HDWP fake_defer_pos (HDWP const dwp, HWND const wnd, const RECT* const rect
+, UINT const flags)
+{
+  call();
+  struct slot* const s = slot_get (wnd);
+  if (s != NULL) place (s, wnd, rect, flags);
+  return dwp;
+}
+
+static bool fake_defer_end (HDWP const dwp)
+{
+  call();
+  ++fake_stats.defer_batches;
+  ++fake_stats.recompositions;
+  return true;
+}
+
+static bool fake_set_pos (HWND const wnd, const RECT* const rect, UINT const flags)
+{
+  call();
+  struct slot* const s = slot_get (wnd);
+  if (s == NULL) return false;
+  place (s, wnd, rect, flags);
+  ++fake_stats.recompositions;
+  return true;
+}
+
+static bool fake_show (HWND const wnd, int const cmd)
+{
+  call();
+  struct slot* const s = slot_get (wnd);
+  if (s == NULL) return false;
+  const bool was = s->w.visible;
+  switch (cmd) {
+  case SW_SHOWMAXIMIZED:
+    if (!s->w.maximized) s->normal = s->w.rect;
+    s->w.maximized = true;
+    s->w.minimized = false;
+    s->w.rect = monitors[0];
+    break;
+  case SW_SHOWMINIMIZED:
+  case SW_SHOWMINNOACTIVE:
+    s->w.minimized = true;
+    break;
+  default:
+    if (s->w.maximized) s->w.rect = s->normal;
+    s->w.maximized = s->w.minimized = false;
+  }
+  s->w.visible = true;
+  ++fake_stats.moves;
+  ++fake_stats.recompositions;
+  if (!was && watch_windows) core_event (CORE_EVENT_SHOW, wnd);
+  location_changed (wnd);
+  return was;
+}
+
+static bool fake_get_placement (HWND const wnd, RECT* const rect, bool* const maximized)
+{
+  call();
+  const struct slot* const s = slot_get (wnd);
+  if (s == NULL) return false;
+  rect[0] = s->w.maximized ? s->normal : s->w.rect;
+  maximized[0] = s->w.maximized;
+  return true;
+}
+
+static bool fake_set_placement (HWND const wnd, const RECT* const rect, bool const maximized)
+{
+  call();
+  struct slot* const s = slot_get (wnd);
+  if (s == NULL) return false;
+  s->normal = rect[0];
+  s->w.rect = maximized ? monitors[0] : rect[0];
+  s->w.maximized = maximized;
+  s->w.minimized = false;
+  ++fake_stats.moves;
+  ++fake_stats.recompositions;
+  location_changed (wnd);
+  return true;
+}
+
+static size_t fake_get_monitors (RECT* const rects, size_t const max)
+{
+  call();
+  for (size_t i = 0; i != monitor_num && i != max; ++i) rects[i] = monitors[i];
+  return monitor_num;
+}
+
+/* -----------------------------------------------------------------------------
+// Hotkeys */
+
+static bool fake_register_hotkey (HWND const wnd, int const id
+, UINT const mod, UINT const code)
+{
+  call();
+  if (code > 0xff || hotkey_taken[mod_index (mod)][code]) return false;
+  struct hotkey_reg* free_reg = NULL;
+  for (size_t i = 0; i != FAKE_HOTKEYS_MAX; ++i) {
+    struct hotkey_reg* const r = hotkeys + i;
+    if (r->wnd == NULL) {
+      if (free_reg == NULL) free_reg = r;
+      continue;
+    }
+    /* Taken by us, or the id is in use */
+    if (r->wnd == wnd && r->id == id) return false;
+    if (mod_index (r->mod) == mod_index (mod) && r->code == code) return false;
+  }
+  if (free_reg == NULL) return false;
+  free_reg[0] = (struct hotkey_reg){wnd, id, mod, code};
+  ++fake_stats.hotkeys;
+  return true;
+}
+
+static bool fake_unregister_hotkey (HWND const wnd, int const id)
+{
+  call();
+  for (size_t i = 0; i != FAKE_HOTKEYS_MAX; ++i) {
+    if (hotkeys[i].wnd == wnd && hotkeys[i].id == id) {
+      hotkeys[i].wnd = NULL;
+      --fake_stats.hotkeys;
+      return true;
+    }
+  }
+  return false;
+}
+
+/* -----------------------------------------------------------------------------
+// Files */
+
+static wchar_t* fake_file_read (const wchar_t* const path)
+{
+  call();
+  return posix_file_read (path);
+}
+
+static bool fake_file_write (const wchar_t* const path, const wchar_t* const text)
+{
+  call();
+  return posix_file_write (path, text);
+}
+
+static bool fake_file_replace (const wchar_t* const src, const wchar_t* const dst)
+{
+  call();
+  return posix_file_replace (src, dst);
+}
+
+static void fake_file_remove (const wchar_t* const path)
+{
+  call();
+  posix_file_remove (path);
+}
+
+/* -----------------------------------------------------------------------------
+// Events, timers and lifetime */
+
+static bool fake_watch (enum core_watch const what, bool const on)
+{
+  call();
+  if (what == CORE_WATCH_WINDOWS) watch_windows = on;
+  else watch_location = on;
+  return true;
+}
+
+static bool fake_set_timer (UINT const id, UINT const ms)
+{
+  call();
+  if (id >= FAKE_TIMERS) return false;
+  if (!timers[id]) ++fake_stats.timers;
+  timers[id] = true;
+  return true;
+}
+
+static void fake_kill_timer (UINT const id)
+{
+  call();
+  if (id >= FAKE_TIMERS || !timers[id]) return;
+  --fake_stats.timers;
+  timers[id] = false;
+}
+
+static bool fake_open (void)
+{
+  call();
+  return true;
+}
+
+static void fake_close (void)
+{
+  call();
+  watch_windows = watch_location = false;
+  for (UINT id = 0; id != FAKE_TIMERS; ++id) fake_kill_timer (id);
+}
+
+static DWORD fake_current_thread (void)
+{
+  return FAKE_UI_THREAD;
+}
+
+const struct backend backend_fake = {
+  .open              = &fake_open,
+  .close             = &fake_close,
+  .current_thread    = &fake_current_thread,
+  .set_timer         = &fake_set_timer,
+  .kill_timer        = &fake_kill_timer,
+  .watch             = &fake_watch,
+  .get_style         = &fake_get_style,
+  .set_style         = &fake_set_style,
+  .get_menu          = &fake_get_menu,
+  .set_menu          = &fake_set_menu,
+  .enum_windows      = &fake_enum_windows,
+  .get_thread        = &fake_get_thread,
+  .get_process       = &fake_get_process,
+  .get_class         = &fake_get_class,
+  .get_title         = &fake_get_title,
+  .get_exe           = &fake_get_exe,
+  .is_top_level      = &fake_is_top_level,
+  .is_visible        = &fake_is_visible,
+  .is_minimized      = &fake_is_minimized,
+  .is_maximized      = &fake_is_maximized,
+  .get_rect          = &fake_get_rect,
+  .get_dpi           = &fake_get_dpi,
+  .repaint           = &fake_repaint,
+  .frame_changed     = &fake_frame_changed,
+  .dwm_border        = &fake_dwm_border,
+  .clip_client       = &fake_clip_client,
+  .get_region        = &fake_get_region,
+  .unclip            = &fake_unclip,
+  .free_region       = &fake_free_region,
+  .veto_attach       = &fake_veto_attach,
+  .veto_detach       = &fake_veto_detach,
+  .defer_begin       = &fake_defer_begin,
+  .defer_pos         = &fake_defer_pos,
+  .defer_end         = &fake_defer_end,
+  .set_pos           = &fake_set_pos,
+  .show              = &fake_show,
+  .get_placement     = &fake_get_placement,
+  .set_placement     = &fake_set_placement,
+  .get_monitors      = &fake_get_monitors,
+  .register_hotkey   = &fake_register_hotkey,
+  .unregister_hotkey = &fake_unregister_hotkey,
+  .file_read         = &fake_file_read,
+  .file_write        = &fake_file_write,
+  .file_replace      = &fake_file_replace,
+  .file_remove       = &fake_file_remove
+};
+
+/* ========================================================================== */
+
+void fake_reset (void)
+{
+  free (slots);
+  slots = NULL;
+  slot_num = slot_cap = 0;
+  free_head = SIZE_MAX;
+  watch_windows = watch_location = false;
+  memset (timers, 0, sizeof(timers));
+  memset (hotkey_taken, 0, sizeof(hotkey_taken));
+  memset (hotkeys, 0, sizeof(hotkeys));
+  monitor_num = 1;
+  monitors[0] = (RECT){0, 0, 1920, 1080};
+  objzero (&fake_stats);
+}
+
+void fake_latency (unsigned const ns)
+{
+  latency = ns;
+}
+
+HWND fake_create (const struct fake_window* const w)
+{
+  size_t i;
+  if (free_head != SIZE_MAX) {
+    i = free_head;
+    free_head = slots[i].next_free;
+  } else {
+    if (!arrreserve (slots, slot_num, slot_cap)) return NULL;
+    i = slot_num++;
+  }
+  struct slot* const s = slots + i;
+  objzero (s);
+  s->w = w[0];
+  s->normal = w->rect;
+  s->thread = next_thread++;
+  ++fake_stats.windows;
+  HWND const wnd = slot_wnd (i);
+  if (watch_windows) {
+    core_event (CORE_EVENT_CREATE, wnd);
+    if (s->w.visible) core_event (CORE_EVENT_SHOW, wnd);
+  }
+  return wnd;
+}
+
+void fake_destroy (HWND const wnd)
+{
+  struct slot* const s = slot_get (wnd);
+  if (s == NULL) return;
+  /* Whatever the window owned goes with it */
+  if (s->clipped) --fake_stats.regions;
+  s->thread = 0;
+  s->next_free = free_head;
+  free_head = s - slots;
+  --fake_stats.windows;
+  for (size_t i = 0; i != FAKE_HOTKEYS_MAX; ++i) {
+    if (hotkeys[i].wnd == wnd) {
+      hotkeys[i].wnd = NULL;
+      --fake_stats.hotkeys;
+    }
+  }
+  if (watch_windows) core_event (CORE_EVENT_DESTROY, wnd);
+}
+
+struct fake_window* fake_get (HWND const wnd)
+{
+  struct slot* const s = slot_get (wnd);
+  return s != NULL ? &s->w : NULL;
+}
+
+void fake_move (HWND const wnd, const RECT* const rect, UINT const dpi)
+{
+  struct slot* const s = slot_get (wnd);
+  if (s == NULL) return;
+  s->w.rect = rect[0];
+  if (dpi != 0) s->w.dpi = dpi;
+  if (!s->w.maximized) s->normal = rect[0];
+  location_changed (wnd);
+}
+
+HMENU fake_menu (void)
+{
+  return (HMENU)(next_menu++ * 4);
+}
+
+size_t fake_run_timers (void)
+{
+  size_t fired = 0;
+  for (UINT id = 0; id != FAKE_TIMERS; ++id) {
+    if (!timers[id]) continue;
+    core_timer (id);
+    ++fired;
+  }
+  return fired;
+}
+
+void fake_set_monitors (const RECT* const rects, size_t num)
+{
+  if (num > FAKE_MONITORS_MAX) num = FAKE_MONITORS_MAX;
+  for (size_t i = 0; i != num; ++i) monitors[i] = rects[i];
+  monitor_num = num;
+}
+
+void fake_hotkey_taken (UINT const mod, UINT const code)
+{
+  if (code <= 0xff) hotkey_taken[mod_index (mod)][code] = true;
+}
@@ -0,0 +1,75 @@
+/* =============================================================================
+// BORDERless: in-memory backend for benchmarks
+//
+// A window table with synthetic handles standing in for the desktop,
+// see `backend.h`. Handles are recycled the way Windows recycles them,
+// each window gets a thread of its own, and every call can be made
+// to take a while to mimic a loaded system. Files are real files,
+// written in UTF-16LE like the WinAPI backend does.
+// -------------------------------------------------------------------------- */
+
+#ifndef BORDERLESS_FAKE_H
+#define BORDERLESS_FAKE_H
+
+#include "libborderless.h"
+#include "backend.h"
+
+struct fake_window {
+  DWORD pid;
+  LONG style;
+  LONG style_ex;
+  HMENU menu;
+  const wchar_t* cls;
+  const wchar_t* title;
+  RECT rect;
+  UINT dpi;
+  bool visible;
+  bool top_level;
+  bool minimized;
+  bool maximized;
+  bool region; // shaped by the application itself
+};
+
+/* What the backend was asked to do since `fake_reset()` */
+struct fake_stats {
+  size_t calls;
+  size_t style_writes;
+  size_t frame_changes;  // frames recomputed
+  size_t repaints;       // forced by moving the window
+  size_t moves;          // placements
+  size_t defer_batches;
+  size_t recompositions; // desktop updates, a batch counts once
+  size_t dwm_calls;
+  /* Objects alive right now: GDI and USER analogs */
+  size_t windows;
+  size_t regions;
+  size_t hooks;
+  size_t timers;
+  size_t hotkeys;
+};
+
+extern const struct backend backend_fake;
+extern struct fake_stats fake_stats;
+
+/* Forgets all windows, timers, hotkeys and statistics */
+void fake_reset (void);
+/* Every backend call spins for this long */
+void fake_latency (unsigned ns);
+
+/* Creation and destruction emit window events while watched */
+HWND fake_create (const struct fake_window* w);
+void fake_destroy (HWND wnd);
+/* NULL if no such window */
+struct fake_window* fake_get (HWND wnd);
+/* Emits a location change while watched */
+void fake_move (HWND wnd, const RECT* rect, UINT dpi);
+/* Unique menu handle */
+HMENU fake_menu (void);
+
+/* Fires every armed timer once */
+size_t fake_run_timers (void);
+void fake_set_monitors (const RECT* rects, size_t num);
+/* Combination taken by some other application */
+void fake_hotkey_taken (UINT mod, UINT code);
+
+#endif
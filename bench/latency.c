@@ -0,0 +1,489 @@
+/* =============================================================================
+// BORDERless: hotkey latency on a real (or Wine) desktop
+//
+// Drives a running `borderless.exe` with scripted input and reports
+// how long it takes from the key press to the border or menu being
+// gone, as p50 and p99 per hotkey.
+//
+// latency gen <script> [windows] [presses] [seed]
+//   Writes a synthetic script: windows of assorted styles come and go
+//   while hotkeys are pressed on them.
+// latency record <script>
+//   Records top-level windows shown and destroyed and every key
+//   pressed with Ctrl, Alt or Win, until Ctrl+C.
+// latency replay <script> [speed]
+//   Plays a script back against `target.exe`, started if not running.
+//   `speed` 2 plays twice as fast, 0 as fast as possible.
+//
+// Script lines, times in ms since the start:
+//   <ms> create <style> <style_ex> <menu> <paint_us> <frame_us>
+//   <ms> destroy <window>
+//   <ms> key <mod> <vk> <window>
+// Windows are numbered in order of creation. Modifiers are `MOD_*`.
+// -------------------------------------------------------------------------- */
+
+#ifndef UNICODE
+#define UNICODE
+#endif
+
+#ifndef _UNICODE
+#define _UNICODE
+#endif
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <windows.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "common.h"
+#include "target.h"
+
+/* A change that didn't happen in this long counts as lost */
+#define LATENCY_TIMEOUT 2000
+
+enum step_kind {
+  STEP_CREATE,
+  STEP_DESTROY,
+  STEP_KEY
+};
+
+struct step {
+  DWORD ms;
+  enum step_kind kind;
+  struct target_window w; // create
+  UINT mod, vk;           // key
+  int wnd;                // destroy, key: -1 for none
+};
+
+static size_t step_num;
+static size_t step_cap;
+static struct step* steps;
+
+static LARGE_INTEGER freq;
+
+static double now_ms (void)
+{
+  LARGE_INTEGER t;
+  QueryPerformanceCounter (&t);
+  return (double)t.QuadPart * 1000.0 / (double)freq.QuadPart;
+}
+
+static bool step_add (const struct step* const s)
+{
+  if (!arrreserve (steps, step_num, step_cap)) return false;
+  steps[step_num++] = s[0];
+  return true;
+}
+
+/* -----------------------------------------------------------------------------
+// Script file */
+
+static bool script_write (const char* const path)
+{
+  FILE* const f = fopen (path, "w");
+  if (f == NULL) return false;
+  for (size_t i = 0; i != step_num; ++i) {
+    const struct step* const s = steps + i;
+    switch (s->kind) {
+    case STEP_CREATE:
+      fprintf (f, "%lu create 0x%08lx 0x%08lx %d %lu %lu\n", (unsigned long)s->ms
+      , (unsigned long)s->w.style, (unsigned long)s->w.style_ex, s->w.menu != FALSE
+      , (unsigned long)s->w.paint_us, (unsigned long)s->w.frame_us);
+      break;
+    case STEP_DESTROY:
+      fprintf (f, "%lu destroy %d\n", (unsigned long)s->ms, s->wnd);
+      break;
+    case STEP_KEY:
+      fprintf (f, "%lu key %u 0x%02x %d\n", (unsigned long)s->ms, s->mod, s->vk, s->wnd);
+      break;
+    }
+  }
+  return fclose (f) == 0;
+}
+
+static bool script_read (const char* const path)
+{
+  FILE* const f = fopen (path, "r");
+  if (f == NULL) return false;
+  char line[256];
+  int num = 0;
+  while (fgets (line, sizeof(line), f) != NULL) {
+    struct step s = {.wnd = -1};
+    unsigned long ms, a, b, c, d;
+    int menu;
+    char kind[16];
+    if (line[0] == '#' || sscanf (line, "%lu %15s", &ms, kind) != 2) continue;
+    s.ms = ms;
+    if (strcmp (kind, "create") == 0
+    && sscanf (line, "%*u %*s %li %li %d %lu %lu", &a, &b, &menu, &c, &d) == 5) {
+      s.kind = STEP_CREATE;
+      s.w = (struct target_window){
+        .style = a, .style_ex = b,
+        .x = 40 + num % 8 * 32, .y = 40 + num % 8 * 32, .width = 640, .height = 480,
+        .menu = menu != 0, .paint_us = c, .frame_us = d
+      };
+      ++num;
+    } else if (strcmp (kind, "destroy") == 0 && sscanf (line, "%*u %*s %d", &s.wnd) == 1) {
+      s.kind = STEP_DESTROY;
+    } else if (strcmp (kind, "key") == 0
+    && sscanf (line, "%*u %*s %u %i %d", &s.mod, &s.vk, &s.wnd) == 3) {
+      s.kind = STEP_KEY;
+    } else continue;
+    if (!step_add (&s)) break;
+  }
+  fclose (f);
+  return step_num != 0;
+}
+
+/* -----------------------------------------------------------------------------
+// Synthetic script */
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t rand32 (void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static bool script_gen (int const windows, int const presses)
+{
+  /* Plain, tool, dialog and popup-ish frames */
+  static const DWORD styles[][2] = {
+    {WS_OVERLAPPEDWINDOW, WS_EX_WINDOWEDGE},
+    {WS_OVERLAPPEDWINDOW, WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE},
+    {WS_CAPTION | WS_SYSMENU | WS_THICKFRAME, WS_EX_TOOLWINDOW},
+    {WS_CAPTION | WS_SYSMENU | WS_DLGFRAME, WS_EX_DLGMODALFRAME}
+  };
+  DWORD ms = 0;
+  int alive = 0, created = 0, left = presses;
+  int* const live = arrnew (int, windows);
+  if (live == NULL) return false;
+  while (created != windows || alive != 0) {
+    ms += 20 + rand32() % 80;
+    const uint32_t r = rand32() % 16;
+    struct step s = {.ms = ms, .wnd = -1};
+    if (created != windows && (alive == 0 || r < 3)) {
+      const int k = rand32() % numof(styles);
+      s.kind = STEP_CREATE;
+      s.w = (struct target_window){
+        .style = styles[k][0], .style_ex = styles[k][1],
+        .menu = rand32() % 2, .paint_us = rand32() % 4 * 500, .frame_us = rand32() % 3 * 250
+      };
+      live[alive++] = created++;
+    } else if (r < 5 || left <= 0) {
+      const int i = rand32() % alive;
+      s.kind = STEP_DESTROY;
+      s.wnd = live[i];
+      live[i] = live[--alive];
+    } else {
+      /* Twice: hide, then restore */
+      s.kind = STEP_KEY;
+      s.mod = MOD_ALT;
+      s.vk = rand32() % 4 != 0 ? 'B' : 'M';
+      s.wnd = live[rand32() % alive];
+      if (!step_add (&s)) break;
+      s.ms = ms += 50;
+      --left;
+    }
+    if (!step_add (&s)) break;
+  }
+  free (live);
+  return true;
+}
+
+/* -----------------------------------------------------------------------------
+// Recording */
+
+static DWORD record_start;
+static DWORD record_thread;
+static size_t record_wnd_num;
+static size_t record_wnd_cap;
+static HWND* record_wnds;
+
+static int record_find (HWND const wnd)
+{
+  for (size_t i = record_wnd_num; i-- != 0;) {
+    if (record_wnds[i] == wnd) return (int)i;
+  }
+  return -1;
+}
+
+static void CALLBACK record_event (HWINEVENTHOOK const hook, DWORD const event
+, HWND const wnd, LONG const obj, LONG const child, DWORD const thread, DWORD const time)
+{
+  if (obj != OBJID_WINDOW || child != CHILDID_SELF || wnd == NULL) return;
+  if (GetAncestor (wnd, GA_ROOT) != wnd) return;
+  struct step s = {.ms = time - record_start, .wnd = -1};
+  if (event == EVENT_OBJECT_SHOW) {
+    /* First time shown counts as created */
+    if (record_find (wnd) >= 0) return;
+    if (!arrreserve (record_wnds, record_wnd_num, record_wnd_cap)) return;
+    record_wnds[record_wnd_num++] = wnd;
+    s.kind = STEP_CREATE;
+    s.w.style = GetWindowLongW (wnd, GWL_STYLE);
+    s.w.style_ex = GetWindowLongW (wnd, GWL_EXSTYLE);
+    s.w.menu = GetMenu (wnd) != NULL;
+  } else {
+    s.wnd = record_find (wnd);
+    if (s.wnd < 0) return;
+    /* Handles get reused */
+    record_wnds[s.wnd] = NULL;
+    s.kind = STEP_DESTROY;
+  }
+  step_add (&s);
+}
+
+static LRESULT CALLBACK record_key (int const code, WPARAM const wparam, LPARAM const lparam)
+{
+  const KBDLLHOOKSTRUCT* const k = (const KBDLLHOOKSTRUCT*)lparam;
+  if (code == HC_ACTION && (wparam == WM_KEYDOWN || wparam == WM_SYSKEYDOWN)
+  && !(k->flags & LLKHF_INJECTED)) {
+    const bool ctrl = GetAsyncKeyState (VK_CONTROL) < 0;
+    const bool alt = GetAsyncKeyState (VK_MENU) < 0;
+    const bool shift = GetAsyncKeyState (VK_SHIFT) < 0;
+    const bool win = GetAsyncKeyState (VK_LWIN) < 0 || GetAsyncKeyState (VK_RWIN) < 0;
+    const UINT vk = k->vkCode;
+    const bool modifier = vk == VK_CONTROL || vk == VK_LCONTROL || vk == VK_RCONTROL
+    || vk == VK_MENU || vk == VK_LMENU || vk == VK_RMENU
+    || vk == VK_SHIFT || vk == VK_LSHIFT || vk == VK_RSHIFT
+    || vk == VK_LWIN || vk == VK_RWIN;
+    if (!modifier && (ctrl || alt || win)) {
+      step_add (&(struct step){
+        .ms = k->time - record_start,
+        .kind = STEP_KEY,
+        .mod = (MOD_CONTROL * ctrl) | (MOD_ALT * alt) | (MOD_SHIFT * shift) | (MOD_WIN * win),
+        .vk = vk,
+        .wnd = record_find (GetForegroundWindow())
+      });
+    }
+  }
+  return CallNextHookEx (NULL, code, wparam, lparam);
+}
+
+static BOOL WINAPI record_stop (DWORD const type)
+{
+  PostThreadMessageW (record_thread, WM_QUIT, 0, 0);
+  return TRUE;
+}
+
+static bool record (void)
+{
+  record_start = GetTickCount();
+  record_thread = GetCurrentThreadId();
+  HWINEVENTHOOK const show = SetWinEventHook (EVENT_OBJECT_SHOW, EVENT_OBJECT_SHOW
+  , NULL, &record_event, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+  HWINEVENTHOOK const destroy = SetWinEventHook (EVENT_OBJECT_DESTROY, EVENT_OBJECT_DESTROY
+  , NULL, &record_event, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+  HHOOK const keys = SetWindowsHookExW (WH_KEYBOARD_LL, &record_key, GetModuleHandleW (NULL), 0);
+  const bool ok = show != NULL && destroy != NULL && keys != NULL;
+  if (ok) {
+    SetConsoleCtrlHandler (&record_stop, TRUE);
+    wprintf (L"Recording, Ctrl+C to stop\n");
+    MSG msg;
+    while (GetMessageW (&msg, NULL, 0, 0)) DispatchMessageW (&msg);
+  }
+  if (keys != NULL) UnhookWindowsHookEx (keys);
+  if (destroy != NULL) UnhookWinEvent (destroy);
+  if (show != NULL) UnhookWinEvent (show);
+  free (record_wnds);
+  return ok;
+}
+
+/* -----------------------------------------------------------------------------
+// Replay */
+
+struct sample {
+  UINT mod, vk;
+  double ms; // negative if nothing changed in time
+};
+
+static size_t sample_num;
+static size_t sample_cap;
+static struct sample* samples;
+
+static HWND target_control (void)
+{
+  HWND ctl = FindWindowExW (HWND_MESSAGE, NULL, TARGET_CONTROL_CLASS, NULL);
+  if (ctl != NULL) return ctl;
+  STARTUPINFOW si = {.cb = sizeof(si)};
+  PROCESS_INFORMATION pi;
+  wchar_t cmd[] = L"target.exe";
+  if (!CreateProcessW (NULL, cmd, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi)) return NULL;
+  WaitForInputIdle (pi.hProcess, 5000);
+  CloseHandle (pi.hThread);
+  CloseHandle (pi.hProcess);
+  for (int i = 0; i != 50 && ctl == NULL; ++i) {
+    Sleep (100);
+    ctl = FindWindowExW (HWND_MESSAGE, NULL, TARGET_CONTROL_CLASS, NULL);
+  }
+  return ctl;
+}
+
+static void send_key (UINT const mod, UINT const vk)
+{
+  static const struct {UINT mod; WORD vk;} mods[] = {
+    {MOD_CONTROL, VK_CONTROL}, {MOD_ALT, VK_MENU}, {MOD_SHIFT, VK_SHIFT}, {MOD_WIN, VK_LWIN}
+  };
+  INPUT in[10];
+  UINT n = 0;
+  for (size_t i = 0; i != numof(mods); ++i) {
+    if (mod & mods[i].mod) in[n++] = (INPUT){.type = INPUT_KEYBOARD, .ki.wVk = mods[i].vk};
+  }
+  in[n++] = (INPUT){.type = INPUT_KEYBOARD, .ki.wVk = vk};
+  in[n++] = (INPUT){.type = INPUT_KEYBOARD, .ki.wVk = vk, .ki.dwFlags = KEYEVENTF_KEYUP};
+  for (size_t i = numof(mods); i-- != 0;) {
+    if (mod & mods[i].mod) in[n++] = (INPUT){.type = INPUT_KEYBOARD
+    , .ki.wVk = mods[i].vk, .ki.dwFlags = KEYEVENTF_KEYUP};
+  }
+  SendInput (n, in, sizeof(INPUT));
+}
+
+/* Key press until the window's styles or menu change */
+static double press (HWND const wnd, UINT const mod, UINT const vk)
+{
+  if (wnd != NULL) {
+    SetForegroundWindow (wnd);
+    for (int i = 0; i != 100 && GetForegroundWindow() != wnd; ++i) Sleep (1);
+  }
+  const LONG style = wnd != NULL ? GetWindowLongW (wnd, GWL_STYLE) : 0;
+  const LONG style_ex = wnd != NULL ? GetWindowLongW (wnd, GWL_EXSTYLE) : 0;
+  HMENU const menu = wnd != NULL ? GetMenu (wnd) : NULL;
+  const double t0 = now_ms();
+  send_key (mod, vk);
+  if (wnd == NULL) return -1;
+  do {
+    if (GetWindowLongW (wnd, GWL_STYLE) != style
+    || GetWindowLongW (wnd, GWL_EXSTYLE) != style_ex
+    || GetMenu (wnd) != menu) return now_ms() - t0;
+    Sleep (0);
+  } while (now_ms() - t0 < LATENCY_TIMEOUT);
+  return -1;
+}
+
+static bool replay (double const speed)
+{
+  HWND const ctl = target_control();
+  if (ctl == NULL) {
+    wprintf (L"Can't start target.exe\n");
+    return false;
+  }
+  size_t wnd_num = 0;
+  HWND* const wnds = arrnew (HWND, step_num);
+  if (wnds == NULL) return false;
+
+  const double start = now_ms();
+  for (size_t i = 0; i != step_num; ++i) {
+    const struct step* const s = steps + i;
+    if (speed > 0) {
+      const double wait = s->ms / speed - (now_ms() - start);
+      if (wait > 0) Sleep ((DWORD)wait);
+    }
+    HWND const wnd = s->wnd >= 0 && (size_t)s->wnd < wnd_num ? wnds[s->wnd] : NULL;
+    switch (s->kind) {
+    case STEP_CREATE: {
+      COPYDATASTRUCT cd = {TARGET_CREATE, sizeof(s->w), (void*)&s->w};
+      wnds[wnd_num++] = (HWND)SendMessageW (ctl, WM_COPYDATA, 0, (LPARAM)&cd);
+      break;
+    }
+    case STEP_DESTROY:
+      if (wnd != NULL) SendMessageW (ctl, TARGET_DESTROY, (WPARAM)wnd, 0);
+      wnds[s->wnd] = NULL;
+      break;
+    case STEP_KEY:
+      if (!arrreserve (samples, sample_num, sample_cap)) break;
+      samples[sample_num++] = (struct sample){s->mod, s->vk, press (wnd, s->mod, s->vk)};
+      break;
+    }
+  }
+
+  /* Whatever the script left behind */
+  for (size_t i = 0; i != wnd_num; ++i) {
+    if (wnds[i] != NULL) SendMessageW (ctl, TARGET_DESTROY, (WPARAM)wnds[i], 0);
+  }
+  free (wnds);
+  return true;
+}
+
+/* -----------------------------------------------------------------------------
+// Report */
+
+static int cmp_double (const void* const a, const void* const b)
+{
+  const double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+static double percentile (const double* const sorted, size_t const num, double const p)
+{
+  size_t i = (size_t)ceil (p * num);
+  return sorted[i != 0 ? i - 1 : 0];
+}
+
+static void report (void)
+{
+  double* const ms = arrnew (double, sample_num);
+  if (ms == NULL) return;
+  wprintf (L"%-12ls %8ls %8ls %8ls %8ls %8ls\n", L"hotkey", L"presses", L"lost"
+  , L"p50 ms", L"p99 ms", L"max ms");
+  for (size_t i = 0; i != sample_num; ++i) {
+    /* Each combination once, on its first sample */
+    bool first = true;
+    for (size_t j = 0; j != i && first; ++j) {
+      first = samples[j].mod != samples[i].mod || samples[j].vk != samples[i].vk;
+    }
+    if (!first) continue;
+    size_t num = 0, lost = 0;
+    for (size_t j = i; j != sample_num; ++j) {
+      if (samples[j].mod != samples[i].mod || samples[j].vk != samples[i].vk) continue;
+      if (samples[j].ms < 0) ++lost;
+      else ms[num++] = samples[j].ms;
+    }
+    wchar_t name[16];
+    _snwprintf (name, numof(name), L"%u+0x%02x", samples[i].mod, samples[i].vk);
+    name[numof(name) - 1] = '\0';
+    if (num == 0) {
+      wprintf (L"%-12ls %8zu %8zu\n", name, lost, lost);
+      continue;
+    }
+    qsort (ms, num, sizeof(ms[0]), &cmp_double);
+    wprintf (L"%-12ls %8zu %8zu %8.2f %8.2f %8.2f\n", name, num + lost, lost
+    , percentile (ms, num, 0.5), percentile (ms, num, 0.99), ms[num - 1]);
+  }
+  free (ms);
+}
+
+/* ========================================================================== */
+
+int main (int const argc, char** const argv)
+{
+  QueryPerformanceFrequency (&freq);
+  if (argc < 3) {
+    wprintf (L"usage: latency gen|record|replay <script> [args]\n");
+    return EXIT_FAILURE;
+  }
+  bool ok = false;
+  if (strcmp (argv[1], "gen") == 0) {
+    if (argc > 5) rng = strtoul (argv[5], NULL, 0);
+    ok = script_gen (argc > 3 ? atoi (argv[3]) : 50, argc > 4 ? atoi (argv[4]) : 200)
+    && script_write (argv[2]);
+  } else if (strcmp (argv[1], "record") == 0) {
+    ok = record() && script_write (argv[2]);
+  } else if (strcmp (argv[1], "replay") == 0) {
+    ok = script_read (argv[2]) && replay (argc > 3 ? atof (argv[3]) : 1.0);
+    if (ok) report();
+  }
+  free (steps);
+  free (samples);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
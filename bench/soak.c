@@ -0,0 +1,263 @@
+/* =============================================================================
+// BORDERless: long-running soak against the in-memory backend
+//
+// Millions of border and menu toggles with every mode, while windows
+// die and their handles get recycled, monitors change DPI and the
+// configuration keeps being saved. Heap in use, resident memory and
+// the GDI/USER analogs of the fake backend are sampled every round.
+// Fails if any of them keeps growing once warmed up, if anything
+// is left behind once all borders are restored, or if a menu hidden
+// along with the border doesn't follow the rules checked first.
+// Builds on POSIX systems, see `build.sh bench`.
+// `soak [rounds] [ops per round]`, 10 by 200000 by default.
+// -------------------------------------------------------------------------- */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+#include "config.h"
+#include "fake.h"
+
+#define SOAK_WINDOWS 1000
+/* Rounds to settle in before sampling counts */
+#define SOAK_WARMUP 2
+/* Heap in use may wobble this much between rounds */
+#define SOAK_HEAP_SLACK (64 * 1024)
+
+static uint32_t rng = 2463534242u;
+
+static inline uint32_t rand32 (void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static const wchar_t* const classes[] = {
+  L"Notepad", L"CabinetWClass", L"Chrome_WidgetWin_1", L"SDL_app",
+  L"Afx:00400000:b", L"ConsoleWindowClass", L"MozillaWindowClass", L"XLMAIN"
+};
+
+static DWORD next_pid = 100;
+
+static HWND spawn (void)
+{
+  const int x = (int)(rand32() % 1000);
+  return fake_create (&(struct fake_window){
+    .pid = next_pid++ / 4,
+    .style = WS_OVERLAPPEDWINDOW | WS_VISIBLE,
+    .style_ex = WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE,
+    .menu = fake_menu(),
+    .cls = classes[rand32() % numof(classes)],
+    .title = L"Untitled",
+    .rect = {x, x, x + 800, x + 600},
+    .dpi = 96,
+    .visible = true,
+    .top_level = true,
+    .region = rand32() % 8 == 0
+  });
+}
+
+/* Menu of a window whose rule hides it with the border: back with
+// the border only if the border hid it, and not once taken over */
+static int menu_ownership (void)
+{
+  HWND const wnd = fake_create (&(struct fake_window){
+    .pid = 1,
+    .style = WS_OVERLAPPEDWINDOW | WS_VISIBLE,
+    .style_ex = WS_EX_WINDOWEDGE,
+    .menu = fake_menu(),
+    .cls = L"SoakMenu",
+    .title = L"Untitled",
+    .rect = {0, 0, 800, 600},
+    .dpi = 96,
+    .visible = true,
+    .top_level = true
+  });
+  borderless_compat_add (L"SoakMenu 0xcf0000 0 move menu");
+  struct borderless_state st;
+  int bad = 0;
+  #define expect(cond, what) do {\
+    if (!(cond)) {\
+      wprintf (L"menu: %ls\n", what);\
+      ++bad;\
+    }\
+  } while (0)
+
+  borderless_menu (wnd, BORDERLESS_HIDE);
+  borderless_border (wnd, BORDERLESS_HIDE);
+  borderless_border (wnd, BORDERLESS_RESTORE);
+  expect (borderless_get_state (wnd, &st) && st.menu, L"hidden by hand, restored with the border");
+  borderless_menu (wnd, BORDERLESS_RESTORE);
+
+  borderless_border (wnd, BORDERLESS_HIDE);
+  expect (borderless_get_state (wnd, &st) && st.menu, L"not hidden with the border");
+  borderless_border (wnd, BORDERLESS_RESTORE);
+  expect (!borderless_get_state (wnd, &st), L"not restored with the border");
+
+  borderless_border (wnd, BORDERLESS_HIDE);
+  borderless_menu (wnd, BORDERLESS_RESTORE);
+  borderless_menu (wnd, BORDERLESS_HIDE);
+  borderless_border (wnd, BORDERLESS_RESTORE);
+  expect (borderless_get_state (wnd, &st) && st.menu, L"taken over, restored with the border");
+  #undef expect
+
+  borderless_menu (wnd, BORDERLESS_RESTORE);
+  borderless_compat_clear();
+  fake_destroy (wnd);
+  return bad;
+}
+
+struct sample {
+  size_t heap;     // bytes in use
+  size_t resident; // pages
+  size_t regions, hooks, timers, hotkeys;
+};
+
+static struct sample sample (void)
+{
+  struct sample s = {
+    .heap = mallinfo2().uordblks,
+    .regions = fake_stats.regions,
+    .hooks = fake_stats.hooks,
+    .timers = fake_stats.timers,
+    .hotkeys = fake_stats.hotkeys
+  };
+  FILE* const f = fopen ("/proc/self/statm", "r");
+  if (f != NULL) {
+    unsigned long size, resident;
+    if (fscanf (f, "%lu %lu", &size, &resident) == 2) s.resident = resident;
+    fclose (f);
+  }
+  return s;
+}
+
+int main (int const argc, char** const argv)
+{
+  const int rounds = argc > 1 ? atoi (argv[1]) : 10;
+  const long ops = argc > 2 ? atol (argv[2]) : 200000;
+  if (rounds <= SOAK_WARMUP) return EXIT_FAILURE;
+
+  borderless_set_backend (&backend_fake);
+  fake_reset();
+  HWND wnds[SOAK_WINDOWS];
+  for (size_t i = 0; i != SOAK_WINDOWS; ++i) wnds[i] = spawn();
+  if (!borderless_init (&(struct borderless_config){
+    .size = sizeof(struct borderless_config),
+    .fullscreen = true
+  })) return EXIT_FAILURE;
+  const int menu_bad = menu_ownership();
+
+  char dir[] = "/tmp/borderless-soak-XXXXXX";
+  if (mkdtemp (dir) == NULL) return EXIT_FAILURE;
+  wchar_t path[256];
+  swprintf (path, numof(path), L"%s/borderless.cfg", dir);
+  hkey_border = hkey_border_def;
+  hkey_menu = hkey_menu_def;
+
+  wprintf (L"%5ls %10ls %10ls %8ls %8ls %8ls %8ls %8ls\n", L"round", L"heap", L"resident"
+  , L"windows", L"regions", L"hooks", L"timers", L"hotkeys");
+  struct sample warm = {0}, peak = {0};
+  size_t toggles = 0, recycled = 0, dpi_changes = 0, saves = 0;
+  bool grew = false;
+  for (int r = 0; r != rounds; ++r) {
+    for (long n = 0; n != ops; ++n) {
+      HWND* const wnd = wnds + rand32() % SOAK_WINDOWS;
+      const uint32_t what = rand32() % 1000;
+      if (what < 600) {
+        borderless_border (*wnd, BORDERLESS_TOGGLE);
+        ++toggles;
+      } else if (what < 900) {
+        borderless_menu (*wnd, BORDERLESS_TOGGLE);
+        ++toggles;
+      } else if (what < 920) {
+        borderless_set_mode (rand32() % 3);
+      } else if (what < 990) {
+        /* Often while tracked: the next window takes its handle */
+        fake_destroy (*wnd);
+        *wnd = spawn();
+        ++recycled;
+      } else if (what < 998) {
+        /* Onto another monitor, or the whole of one */
+        const struct fake_window* const w = fake_get (*wnd);
+        const RECT full = {0, 0, 1920, 1080};
+        fake_move (*wnd, what & 1 ? &full : &w->rect, w->dpi == 96 ? 144 : 96);
+        ++dpi_changes;
+      } else if (what < 999) {
+        core_display_changed();
+      } else fake_run_timers();
+
+      if (n % 20000 == 0) {
+        wchar_t* const text = malloc (CONFIG_SIZE * sizeof(wchar_t));
+        if (text == NULL) return EXIT_FAILURE;
+        config_format (text);
+        saves += config_write (path, text);
+        free (text);
+      }
+    }
+    fake_run_timers();
+
+    const struct sample s = sample();
+    wprintf (L"%5d %10zu %10zu %8zu %8zu %8zu %8zu %8zu\n", r, s.heap, s.resident
+    , fake_stats.windows, s.regions, s.hooks, s.timers, s.hotkeys);
+    if (r < SOAK_WARMUP) continue;
+    if (r == SOAK_WARMUP) {
+      warm = peak = s;
+      continue;
+    }
+    /* Growth past the warmed-up high water mark, in the second half */
+    #define check(field, slack) do {\
+      if (r >= (rounds + SOAK_WARMUP) / 2 && s.field > peak.field + (slack)) {\
+        wprintf (L"%ls grew: %zu -> %zu\n", L"" #field, peak.field, s.field);\
+        grew = true;\
+      }\
+      if (r < (rounds + SOAK_WARMUP) / 2 && s.field > peak.field) peak.field = s.field;\
+    } while (0)
+    check (heap, SOAK_HEAP_SLACK);
+    check (regions, 0);
+    check (hooks, 0);
+    check (timers, 0);
+    check (hotkeys, 0);
+    #undef check
+  }
+
+  /* Nothing may be left behind */
+  borderless_set_fullscreen (false);
+  for (size_t i = 0; i != SOAK_WINDOWS; ++i) {
+    borderless_border (wnds[i], BORDERLESS_RESTORE);
+    borderless_menu (wnds[i], BORDERLESS_RESTORE);
+  }
+  fake_run_timers();
+  const bool inventory = core_inventory_check();
+  borderless_shutdown();
+  const struct sample end = sample();
+  const bool leaked = end.regions != 0 || end.hooks != 0 || end.timers != 0 || end.hotkeys != 0;
+
+  wchar_t tmp[256];
+  swprintf (tmp, numof(tmp), L"%ls.tmp", path);
+  backend->file_remove (tmp);
+  backend->file_remove (path);
+  rmdir (dir);
+
+  wprintf (L"%zu toggles, %zu windows recycled, %zu DPI changes, %zu saves\n"
+  L"heap %zu after warmup, %zu at the end; left behind: %zu regions, %zu hooks"
+  L", %zu timers, %zu hotkeys; inventory %ls\n"
+  , toggles, recycled, dpi_changes, saves, warm.heap, end.heap
+  , end.regions, end.hooks, end.timers, end.hotkeys, inventory ? L"in sync" : L"out of sync");
+  return grew || leaked || !inventory || menu_bad != 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+/* =============================================================================
+// BORDERless: synthetic target application
+//
+// Hosts windows for `latency.exe` to hide borders and menus of.
+// Each window has the styles, menu and painting cost it is asked for,
+// so slow and fast applications can be told apart. Windows are created
+// and destroyed on request through a message-only control window:
+//
+// - `WM_COPYDATA` with a `struct target_window` creates a window
+//   and returns its handle;
+// - `TARGET_DESTROY` with the handle in `wparam` destroys it.
+//
+// Runs until the control window gets `WM_CLOSE`.
+// -------------------------------------------------------------------------- */
+
+#ifndef UNICODE
+#define UNICODE
+#endif
+
+#ifndef _UNICODE
+#define _UNICODE
+#endif
+
+#include <windows.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "target.h"
+
+static HINSTANCE instance;
+static LARGE_INTEGER freq;
+
+/* Costs are per window */
+struct target_state {
+  DWORD paint_us;
+  DWORD frame_us;
+};
+
+static void spin_us (DWORD const us)
+{
+  if (us == 0) return;
+  LARGE_INTEGER t0, t;
+  QueryPerformanceCounter (&t0);
+  do QueryPerformanceCounter (&t);
+  while ((t.QuadPart - t0.QuadPart) * 1000000 / freq.QuadPart < us);
+}
+
+static LRESULT CALLBACK target_proc (HWND const wnd, UINT const msg
+, WPARAM const wparam, LPARAM const lparam)
+{
+  struct target_state* const s = (struct target_state*)GetWindowLongPtrW (wnd, GWLP_USERDATA);
+  switch (msg) {
+  case WM_NCCREATE:
+    SetWindowLongPtrW (wnd, GWLP_USERDATA
+    , (LONG_PTR)((CREATESTRUCTW*)lparam)->lpCreateParams);
+    break;
+  /* Frame recalculation: what hiding the border triggers */
+  case WM_NCCALCSIZE:
+    if (s != NULL) spin_us (s->frame_us);
+    break;
+  case WM_PAINT: {
+    PAINTSTRUCT ps;
+    HDC const dc = BeginPaint (wnd, &ps);
+    FillRect (dc, &ps.rcPaint, (HBRUSH)(COLOR_WINDOW + 1));
+    if (s != NULL) spin_us (s->paint_us);
+    EndPaint (wnd, &ps);
+    return 0;
+  }
+  case WM_NCDESTROY:
+    free (s);
+    break;
+  }
+  return DefWindowProcW (wnd, msg, wparam, lparam);
+}
+
+static HWND target_create (const struct target_window* const w)
+{
+  struct target_state* const s = malloc (sizeof(*s));
+  if (s == NULL) return NULL;
+  s->paint_us = w->paint_us;
+  s->frame_us = w->frame_us;
+
+  HMENU menu = NULL;
+  if (w->menu) {
+    menu = CreateMenu();
+    AppendMenuW (menu, MF_STRING, 1, L"&File");
+    AppendMenuW (menu, MF_STRING, 2, L"&Edit");
+    AppendMenuW (menu, MF_STRING, 3, L"&Help");
+  }
+  HWND const wnd = CreateWindowExW (w->style_ex, TARGET_CLASS, L"Target"
+  , w->style, w->x, w->y, w->width, w->height, NULL, menu, instance, s);
+  if (wnd == NULL) {
+    if (menu != NULL) DestroyMenu (menu);
+    free (s);
+    return NULL;
+  }
+  ShowWindow (wnd, SW_SHOWNORMAL);
+  UpdateWindow (wnd);
+  return wnd;
+}
+
+static LRESULT CALLBACK control_proc (HWND const wnd, UINT const msg
+, WPARAM const wparam, LPARAM const lparam)
+{
+  switch (msg) {
+  case WM_COPYDATA: {
+    const COPYDATASTRUCT* const cd = (const COPYDATASTRUCT*)lparam;
+    if (cd->dwData != TARGET_CREATE || cd->cbData != sizeof(struct target_window)) return 0;
+    return (LRESULT)target_create ((const struct target_window*)cd->lpData);
+  }
+  case TARGET_DESTROY:
+    return DestroyWindow ((HWND)wparam);
+  case WM_CLOSE:
+    PostQuitMessage (0);
+    return 0;
+  }
+  return DefWindowProcW (wnd, msg, wparam, lparam);
+}
+
+int WINAPI wWinMain (HINSTANCE const inst, HINSTANCE const prev
+, LPWSTR const cmd, int const show)
+{
+  instance = inst;
+  QueryPerformanceFrequency (&freq);
+
+  WNDCLASSW wc = {
+    .lpfnWndProc = &target_proc,
+    .hInstance = inst,
+    .hCursor = LoadCursorW (NULL, IDC_ARROW),
+    .lpszClassName = TARGET_CLASS
+  };
+  if (RegisterClassW (&wc) == 0) return EXIT_FAILURE;
+  wc.lpfnWndProc = &control_proc;
+  wc.lpszClassName = TARGET_CONTROL_CLASS;
+  if (RegisterClassW (&wc) == 0) return EXIT_FAILURE;
+  if (CreateWindowW (TARGET_CONTROL_CLASS, NULL, 0, 0, 0, 0, 0
+  , HWND_MESSAGE, NULL, inst, NULL) == NULL) return EXIT_FAILURE;
+
+  MSG msg;
+  while (GetMessageW (&msg, NULL, 0, 0)) {
+    TranslateMessage (&msg);
+    DispatchMessageW (&msg);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,27 @@
+/* =============================================================================
+// BORDERless: synthetic target application protocol
+//
+// Shared by `target.c` and `latency.c`.
+// -------------------------------------------------------------------------- */
+
+#ifndef BORDERLESS_TARGET_H
+#define BORDERLESS_TARGET_H
+
+#define TARGET_CLASS L"BORDERlessTarget"
+#define TARGET_CONTROL_CLASS L"BORDERlessTargetControl"
+
+/* `COPYDATASTRUCT::dwData` of a window creation request */
+#define TARGET_CREATE 0x7461
+/* `wparam` is the window to destroy */
+#define TARGET_DESTROY (WM_APP + 1)
+
+struct target_window {
+  DWORD style;
+  DWORD style_ex;
+  int x, y, width, height;
+  BOOL menu;
+  DWORD paint_us; // spent in every `WM_PAINT`
+  DWORD frame_us; // spent in every `WM_NCCALCSIZE`
+};
+
+#endif
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Hotkey latency under Wine on a virtual X display.
+# Needs Xvfb and Wine, and `./build.sh` run first.
+# `bench/wine.sh [script] [speed]`: replays `script`, or a synthetic
+# one made on the spot, and prints p50/p99 per hotkey.
+set -e
+cd "$(dirname "$0")"
+
+export DISPLAY=${DISPLAY_NUM:-:99}
+export WINEDEBUG=${WINEDEBUG:--all}
+Xvfb "$DISPLAY" -screen 0 1920x1080x24 -nolisten tcp &
+xvfb=$!
+trap 'wineserver -k; kill $xvfb' EXIT
+sleep 1
+
+# The app under test, with its default hotkeys: Alt+B and Alt+M
+wine ../borderless.exe &
+sleep 3
+
+script=${1:-synthetic.txt}
+if [ -z "$1" ]; then
+  wine latency.exe gen "$script" 50 200
+fi
+wine latency.exe replay "$script" "${2:-1}"
@@ -0,0 +1,164 @@
+/* =============================================================================
+// BORDERless: X11 backend test
+//
+// Creates windows and lists them in `_NET_CLIENT_LIST` itself, standing
+// in for a window manager, then hides and restores their borders and
+// checks `_MOTIF_WM_HINTS` as another client sees them. Also times
+// toggling all of them at once with `borderless_border_pid()`, in
+// round trips as much as in microseconds.
+// Needs an X server without a window manager, see `bench/xvfb.sh`.
+// `xcb_test [windows]`, 64 by default.
+// -------------------------------------------------------------------------- */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <time.h>
+#include <unistd.h>
+#include <xcb/xcb.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+
+#define TEST_ROUNDS 100
+
+static xcb_connection_t* conn;
+static xcb_window_t root;
+
+static xcb_atom_t atom (const char* const name)
+{
+  xcb_intern_atom_reply_t* const r = xcb_intern_atom_reply (conn
+  , xcb_intern_atom (conn, 0, strlen (name), name), NULL);
+  const xcb_atom_t a = r != NULL ? r->atom : XCB_ATOM_NONE;
+  free (r);
+  return a;
+}
+
+static inline double now_us (void)
+{
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+/* Decorations as set on the window, -1 if none are */
+static long decorations (xcb_window_t const wnd, xcb_atom_t const hints)
+{
+  xcb_get_property_reply_t* const r = xcb_get_property_reply (conn
+  , xcb_get_property (conn, 0, wnd, hints, hints, 0, 5), NULL);
+  long decor = -1;
+  if (r != NULL && r->format == 32 && xcb_get_property_value_length (r) == 20) {
+    const uint32_t* const v = xcb_get_property_value (r);
+    if (v[0] & 2) decor = v[2];
+  }
+  free (r);
+  return decor;
+}
+
+int main (int const argc, char** const argv)
+{
+  const int num = argc > 1 ? atoi (argv[1]) : 64;
+  if (num <= 0) return EXIT_FAILURE;
+
+  conn = xcb_connect (NULL, NULL);
+  if (xcb_connection_has_error (conn)) {
+    wprintf (L"no X server\n");
+    return EXIT_FAILURE;
+  }
+  const xcb_screen_t* const screen = xcb_setup_roots_iterator (xcb_get_setup (conn)).data;
+  root = screen->root;
+  const xcb_atom_t hints = atom ("_MOTIF_WM_HINTS");
+  const xcb_atom_t client_list = atom ("_NET_CLIENT_LIST");
+  const xcb_atom_t wm_pid = atom ("_NET_WM_PID");
+
+  /* What a window manager would do on map */
+  xcb_window_t* const wnds = arrnew (xcb_window_t, num);
+  if (wnds == NULL) return EXIT_FAILURE;
+  const uint32_t pid = (uint32_t)getpid();
+  for (int i = 0; i != num; ++i) {
+    wnds[i] = xcb_generate_id (conn);
+    xcb_create_window (conn, XCB_COPY_FROM_PARENT, wnds[i], root, i * 8, i * 8, 640, 480, 0
+    , XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual, 0, NULL);
+    xcb_change_property (conn, XCB_PROP_MODE_REPLACE, wnds[i], wm_pid, XCB_ATOM_CARDINAL
+    , 32, 1, &pid);
+    xcb_change_property (conn, XCB_PROP_MODE_REPLACE, wnds[i], XCB_ATOM_WM_CLASS
+    , XCB_ATOM_STRING, 8, 14, "xcb_test\0Test\0");
+    xcb_map_window (conn, wnds[i]);
+  }
+  xcb_change_property (conn, XCB_PROP_MODE_REPLACE, root, client_list, XCB_ATOM_WINDOW
+  , 32, num, wnds);
+  /* Round trip: all of the above is done */
+  free (xcb_get_input_focus_reply (conn, xcb_get_input_focus (conn), NULL));
+
+  borderless_set_backend (&backend_xcb);
+  if (!borderless_init (NULL)) {
+    wprintf (L"borderless_init() failed\n");
+    return EXIT_FAILURE;
+  }
+  /* Map events first */
+  backend_xcb_wait (0, NULL);
+
+  bool ok = true;
+  #define check(cond, ...) do {\
+    if (!(cond)) {\
+      wprintf (L"FAIL: " __VA_ARGS__);\
+      wprintf (L"\n");\
+      ok = false;\
+    }\
+  } while (0)
+
+  HWND const wnd = (HWND)(uintptr_t)wnds[0];
+  check (borderless_border (wnd, BORDERLESS_HIDE), L"hide");
+  check (decorations (wnds[0], hints) == 0, L"decorations after hide: %ld"
+  , decorations (wnds[0], hints));
+  struct borderless_state state;
+  check (borderless_get_state (wnd, &state) && state.border, L"state after hide");
+  check (borderless_border (wnd, BORDERLESS_RESTORE), L"restore");
+  const long restored = decorations (wnds[0], hints);
+  check (restored != 0 && restored != -1, L"decorations after restore: %ld", restored);
+  check (!borderless_get_state (wnd, &state), L"state after restore");
+  check (!borderless_menu (wnd, BORDERLESS_HIDE), L"menu on X");
+
+  /* All windows of the process: one batch per toggle */
+  size_t changed = 0;
+  const double t0 = now_us();
+  for (int r = 0; r != TEST_ROUNDS; ++r) {
+    changed += borderless_border_pid (pid, BORDERLESS_TOGGLE);
+    /* Properties are fetched again after events */
+    backend_xcb_wait (0, NULL);
+  }
+  const double t = now_us() - t0;
+  check (changed == (size_t)num * TEST_ROUNDS, L"batch toggled %zu of %zu", changed
+  , (size_t)num * TEST_ROUNDS);
+  for (int i = 0; i != num; ++i) {
+    check (decorations (wnds[i], hints) != 0, L"window %d left borderless", i);
+  }
+  wprintf (L"%d windows: %.1f us per batch toggle, %.2f us per window\n"
+  , num, t / TEST_ROUNDS, t / TEST_ROUNDS / num);
+
+  /* Gone from the list: no longer tracked */
+  borderless_border (wnd, BORDERLESS_HIDE);
+  xcb_change_property (conn, XCB_PROP_MODE_REPLACE, root, client_list, XCB_ATOM_WINDOW
+  , 32, num - 1, wnds + 1);
+  xcb_destroy_window (conn, wnds[0]);
+  xcb_flush (conn);
+  backend_xcb_wait (100, NULL);
+  check (!borderless_get_state (wnd, &state), L"destroyed window still tracked");
+  check (core_inventory_check(), L"inventory out of sync");
+
+  borderless_shutdown();
+  for (int i = 1; i != num; ++i) xcb_destroy_window (conn, wnds[i]);
+  xcb_disconnect (conn);
+  free (wnds);
+  wprintf (ok ? L"ok\n" : L"failed\n");
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,14 @@
+#!/bin/sh
+# X11 backend test on a virtual X display, without a window manager.
+# Needs Xvfb, and `./build.sh x11` run first.
+# `bench/xvfb.sh [windows]`
+set -e
+cd "$(dirname "$0")"
+
+export DISPLAY=${DISPLAY_NUM:-:98}
+Xvfb "$DISPLAY" -screen 0 1920x1080x24 -nolisten tcp &
+xvfb=$!
+trap 'kill $xvfb' EXIT
+sleep 1
+
+./xcb_test "${1:-64}"
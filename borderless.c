@@ -37,33 +37,20 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif
 
-#include <Windows.h>
-#include <Shlobj.h>
+#include <windows.h>
+#include <shlobj.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <assert.h>
 #include <wchar.h>
+#include <io.h>
 
-/* -----------------------------------------------------------------------------
-// C array */
-#define numof(arr) (sizeof(arr) / sizeof(arr[0]))
-#define arrnew(type, num) malloc ((num) * sizeof(type))
-#define arrsize(arr, num) ((num) * sizeof((arr)[0]))
-#define arrnewsize(arr, num) realloc (arr, arrsize (arr, num))
-#define arrcopy(dst, src, num) memcpy (dst, src, arrsize (dst, num))
-#define arrmove(dst, src, num) memmove (dst, src, arrsize (dst, num))
-#define arrzero(arr, num) memset (arr, 0, arrsize (arr, num))
-#define objzero(obj) arrzero (obj, 1)
-
-/* C constant string */
-#define cstrlen(str) (sizeof(str) / sizeof(str[0]) - 1)
-#define cstrniequ(str, cstr) (_wcsnicmp (str, cstr, cstrlen(cstr)) == 0)
-
-/* Additional character tests */
-#define iswalphab(c) ((c) >= 'a' && (c) <= 'z')
-#define iswdigit09(c) ((c) >= '0' && (c) <= '9')
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+#include "config.h"
 
 /* -----------------------------------------------------------------------------
 // BORDERless is DPI-aware! Huh. */
@@ -95,44 +82,16 @@ static HWND cbox_hkey_hide_border;
 static HWND edit_hkey_hide_border;
 static HWND cbox_hkey_hide_menu;
 static HWND edit_hkey_hide_menu;
+static HWND cbox_fullscreen;
 static HWND cbox_coffee;
 static HMENU menu_popup;
 static HFONT font_gui;
 static WNDPROC edit_wnd_proc;
 
 static bool first_run;
-static bool show_coffee = true;
-
-/* Default masks for WinAPI window styles */
-static LONG style_mask = WS_CAPTION | WS_MAXIMIZEBOX | WS_MINIMIZEBOX
-| WS_SYSMENU | WS_THICKFRAME;
-static LONG style_ex_mask = WS_EX_CLIENTEDGE | WS_EX_STATICEDGE
-| WS_EX_WINDOWEDGE | WS_EX_DLGMODALFRAME;
 
 /* -----------------------------------------------------------------------------
 // Utilities */
-#define parse_mask parse_hex
-
-static inline unsigned long parse_hex (const wchar_t* const str)
-{
-  wchar_t** end = (wchar_t**)&str;
-  return wcstoul (str, end, 16);
-}
-
-static inline bool is_maximized (const HWND wnd)
-{
-  WINDOWPLACEMENT place = {.length = sizeof(place)};
-  GetWindowPlacement (wnd, &place);
-  return place.showCmd == SW_SHOWMAXIMIZED;
-}
-
-static inline bool is_minimized (const HWND wnd)
-{
-  WINDOWPLACEMENT place = {.length = sizeof(place)};
-  GetWindowPlacement (wnd, &place);
-  return place.showCmd == SW_SHOWMINIMIZED;
-}
-
 static inline bool is_visible (const HWND wnd)
 {
   return IsWindowVisible (wnd);
@@ -199,338 +158,28 @@ static bool get_config_path (void)
   return true;
 }
 
-/* -----------------------------------------------------------------------------
-// Hide borders */
-
-struct border_store_item {
-  HWND wnd;
-  LONG style;
-  LONG style_ex;
-};
-
-static size_t border_store_size;
-static struct border_store_item* border_store;
+/* Settings are saved shortly after they change rather than on exit only.
+// Bursts of changes are coalesced on a timer, and the actual writing
+// happens on a background thread, so the UI never waits on disk. */
+#define TIMER_CONFIG 3
+#define CONFIG_DELAY 1000
 
-static void force_repaint_window (const HWND wnd)
+/* Called by the UI whenever some setting changes */
+static void config_changed (void)
 {
-  RECT r;
-  if (is_maximized (wnd)) {
-    InvalidateRect (wnd, NULL, TRUE);
-    UpdateWindow (wnd);
-    return;
-  }
-  GetWindowRect (wnd, &r);
-  MoveWindow (wnd, r.left, r.top, r.right - r.left - 1, r.bottom - r.top - 1, FALSE);
-  MoveWindow (wnd, r.left, r.top, r.right - r.left, r.bottom - r.top, TRUE);
-}
-
-static bool remove_border (const HWND wnd)
-{
-  if (wnd == wnd_main) return false;
-
-  const LONG style = GetWindowLongW (wnd, GWL_STYLE);
-  if (style == 0) return false;
-  const LONG style_ex = GetWindowLongW (wnd, GWL_EXSTYLE);
-  if (style_ex == 0) return false;
-
-  /* See if border is to be hidden or restored */
-  bool hide = true;
-  struct border_store_item* r = border_store;
-  while (r != border_store + border_store_size) {
-    if (r->wnd == wnd) {
-      hide = false;
-      break;
-    }
-    ++r;
-  }
-
-  if (hide) {
-    void* const newptr = arrnewsize (border_store, border_store_size + 1);
-    if (newptr == NULL) return false;
-    border_store = newptr;
-    border_store[border_store_size++] = (struct border_store_item){
-      .wnd = wnd,
-      .style = style,
-      .style_ex = style_ex
-    };
-
-    SetWindowLongW (wnd, GWL_EXSTYLE, style_ex & ~style_ex_mask);
-    SetWindowLongW (wnd, GWL_STYLE, style & ~style_mask);
-    force_repaint_window (wnd);
-  } else {
-    SetWindowLongW (wnd, GWL_STYLE, r->style);
-    SetWindowLongW (wnd, GWL_EXSTYLE, r->style_ex);
-    force_repaint_window (wnd);
-
-    arrmove (r, r + 1, (border_store_size - (r + 1 - border_store)));
-    void* const newptr = arrnewsize (border_store, --border_store_size);
-    if (newptr != NULL || border_store_size == 0) border_store = newptr;
-  }
-
-  return true;
+  /* Re-arming the timer with the same id restarts the countdown */
+  SetTimer (wnd_main, TIMER_CONFIG, CONFIG_DELAY, NULL);
 }
 
 /* -----------------------------------------------------------------------------
-// Hide menu */
-
-struct top_level_test {
-  const HWND wnd;
-  bool is_top_level;
-};
-
-static BOOL CALLBACK enum_top_level (HWND const wnd, LPARAM const lparam)
-{
-  struct top_level_test* const test = (struct top_level_test*)lparam;
-  if (test->wnd == wnd) {
-    test->is_top_level = true;
-    return FALSE;
-  }
-  return TRUE;
-}
-
-struct menu_store_item {
-  HWND wnd;
-  HMENU menu;
-};
+// Thread confinement
 
-static size_t menu_store_size;
-static struct menu_store_item* menu_store;
+// Settings belong to the UI thread, and so does everything
+// tracked by the library. Other threads only ever get copies,
+// see `config_flush()`. */
+static DWORD ui_thread;
 
-static bool remove_menu (const HWND wnd)
-{
-  if (wnd == wnd_main) return false;
-
-  /* Find out if the window is a top-level window first */
-  struct top_level_test test = {.wnd = wnd};
-  EnumWindows (&enum_top_level, (LPARAM)&test);
-  if (!test.is_top_level) return false;
-
-  /* See if menu is to be hidden or restored */
-  bool hide = true;
-  struct menu_store_item* r = menu_store;
-  while (r != menu_store + menu_store_size) {
-    if (r->wnd == wnd) {
-      hide = false;
-      break;
-    }
-    ++r;
-  }
-
-  if (hide) {
-    HMENU const menu = GetMenu (wnd);
-    if (menu != NULL) {
-      void* const newptr = arrnewsize (menu_store, menu_store_size + 1);
-      if (newptr == NULL) return false;
-      menu_store = newptr;
-      menu_store[menu_store_size++] = (struct menu_store_item){
-        .wnd = wnd,
-        .menu = menu
-      };
-      SetMenu (wnd, NULL);
-    }
-  } else {
-    SetMenu (wnd, r->menu);
-    arrmove (r, r + 1, (menu_store_size - (r + 1 - menu_store)));
-    void* const newptr = arrnewsize (menu_store, --menu_store_size);
-    if (newptr != NULL || menu_store_size == 0) menu_store = newptr;
-  }
-
-  return true;
-}
-
-/* -----------------------------------------------------------------------------
-// Hotkey */
-
-static const wchar_t hkey_str_off[]    = L"Off+";
-static const wchar_t hkey_str_ctrl[]   = L"Ctrl+";
-static const wchar_t hkey_str_alt[]    = L"Alt+";
-static const wchar_t hkey_str_shift[]  = L"Shift+";
-static const wchar_t hkey_str_win[]    = L"Win+";
-static const wchar_t hkey_str_ins[]    = L"Insert";
-static const wchar_t hkey_str_del[]    = L"Delete";
-static const wchar_t hkey_str_home[]   = L"Home";
-static const wchar_t hkey_str_end[]    = L"End";
-static const wchar_t hkey_str_pgup[]   = L"PageUp";
-static const wchar_t hkey_str_pgdn[]   = L"PageDown";
-static const wchar_t hkey_str_num[]    = L"Num";
-static const wchar_t hkey_str_div[]    = L"Divide";
-static const wchar_t hkey_str_mul[]    = L"Multiply";
-static const wchar_t hkey_str_sub[]    = L"Subtract";
-static const wchar_t hkey_str_add[]    = L"Add";
-static const wchar_t hkey_str_dec[]    = L"Decimal";
-static const wchar_t hkey_str_left[]   = L"Left";
-static const wchar_t hkey_str_up[]     = L"Up";
-static const wchar_t hkey_str_right[]  = L"Right";
-static const wchar_t hkey_str_down[]   = L"Down";
-static const wchar_t hkey_str_tab[]    = L"Tab";
-static const wchar_t hkey_str_bckspc[] = L"Backspace";
-
-struct hotkey {
-  /* Currently set state */
-  union {
-    struct {
-      char ctrl, alt, shift, win;
-    };
-    int mod;
-  };
-  UINT code;
-  /* Last working state. If currently set state fails to register,
-  // this is restored. If last working state fails as well,
-  // the default combination is restored. If even that
-  // fails, the hotkey gets disabled. */
-  union {
-    struct {
-      char wctrl, walt, wshift, wwin;
-    };
-    int wmod;
-  };
-  UINT wcode;
-  /* Hotkey registration */
-  bool disabled;
-  bool clear; // used by UI
-  bool set; // `code` and `mod` are valid or not
-  bool reg; // registered
-  int id;
-};
-
-struct hotkey hkey_border;
-struct hotkey hkey_border_def = (struct hotkey){
-  .ctrl = false, .alt = true, .shift = false, .win = false,
-  .code = 'B', .id = 1
-};
-struct hotkey hkey_menu;
-struct hotkey hkey_menu_def = (struct hotkey){
-  .ctrl = false, .alt = true, .shift = false, .win = false,
-  .code = 'M', .id = 2
-};
-
-static inline void hotkey_save (struct hotkey* const hkey)
-{
-  hkey->wmod = hkey->mod;
-  hkey->wcode = hkey->code;
-}
-
-static inline void hotkey_restore (struct hotkey* const hkey)
-{
-  hkey->mod = hkey->wmod;
-  hkey->code = hkey->wcode;
-}
-
-static inline bool hotkey_is_set (const struct hotkey* const hkey)
-{
-  return (hkey->code >= 0x70 && hkey->code <= 0x87)
-  || (hkey->code != 0 && hkey->mod != 0);
-}
-
-static inline int hotkey_mod_to_int (const struct hotkey* const hkey)
-{
-  return (MOD_CONTROL * hkey->ctrl) | (MOD_ALT * hkey->alt)
-  | (MOD_SHIFT * hkey->shift) | (MOD_WIN * hkey->win)
-  | MOD_NOREPEAT;
-}
-
-static bool hotkey_unregister (HWND const wnd, struct hotkey* const hkey)
-{
-  if (hkey->reg) {
-    if (!UnregisterHotKey (wnd, hkey->id)) return false;
-    hkey->reg = false;
-  }
-  return true;
-}
-
-static bool hotkey_register (HWND const wnd, struct hotkey* const hkey)
-{
-  if (!hotkey_unregister (wnd, hkey)) return false;
-  if (hkey->disabled || hkey->code == 0) return true;
-  if (!RegisterHotKey (wnd, hkey->id, hotkey_mod_to_int (hkey), hkey->code)) {
-    if (hkey->wcode != 0) {
-      if (hkey->wcode != hkey->code || hkey->wmod != hkey->mod) {
-        hotkey_restore (hkey);
-        if (!RegisterHotKey (wnd, hkey->id, hotkey_mod_to_int (hkey), hkey->code)) {
-          hkey->disabled = true;
-        } else hkey->reg = true;
-      } else hkey->disabled = true;
-    }
-    return false;
-  }
-  /* Remember keystroke as it was successfully registered */
-  hotkey_save (hkey);
-  hkey->reg = true;
-  return true;
-}
-
-static void hotkey_to_str (wchar_t* const str, const struct hotkey* const hkey
-, const bool conf)
-{
-#define hkeychar(c) *s++ = c; s[0] = '\0'
-#define hkeystr(cstr) wcscpy (s, cstr); s += cstrlen(cstr)
-  wchar_t* s = str;
-  if (conf && hkey->disabled) {wcscpy (s, hkey_str_off); s += cstrlen(hkey_str_off);}
-  /* Modifiers */
-  if (hkey->ctrl)  {wcscpy (s, hkey_str_ctrl);  s += cstrlen (hkey_str_ctrl);}
-  if (hkey->alt)   {wcscpy (s, hkey_str_alt);   s += cstrlen (hkey_str_alt);}
-  if (hkey->shift) {wcscpy (s, hkey_str_shift); s += cstrlen (hkey_str_shift);}
-  if (hkey->win)   {wcscpy (s, hkey_str_win);   s += cstrlen (hkey_str_win);}
-  /* Actual key */
-  if (hkey->code) {
-    const UINT key = hkey->code;
-    /* Functional */
-    if      (key >= 0x70 && key <= 0x87) {*s++ = 'F'; _itow (key - 0x70 + 1, s, 10);}
-    /* Numpad */
-    else if (key >= 0x60 && key <= 0x69) {wcscpy (s, hkey_str_num); s += cstrlen(hkey_str_num); _itow (key - 0x60, s, 10);}
-    else switch (key) {
-    /* ;: */case VK_OEM_1: hkeychar (';'); break;
-    /* /? */case VK_OEM_2: hkeychar ('/'); break;
-    /* `~ */case VK_OEM_3: hkeychar ('`'); break;
-    /* [{ */case VK_OEM_4: hkeychar ('['); break;
-    /* \| */case VK_OEM_5: hkeychar('\\'); break;
-    /* ]} */case VK_OEM_6: hkeychar (']'); break;
-    /* '" */case VK_OEM_7: hkeychar('\''); break;
-    /* -_ */case VK_OEM_MINUS:  hkeychar ('-'); break;
-    /* =+ */case VK_OEM_PLUS:   hkeychar ('='); break;
-    /* ,< */case VK_OEM_COMMA:  hkeychar (','); break;
-    /* .> */case VK_OEM_PERIOD: hkeychar ('.'); break;
-    /* Numpad arithmetic operators and decimal separator */
-    case VK_DIVIDE:   hkeystr (hkey_str_div); break;
-    case VK_MULTIPLY: hkeystr (hkey_str_mul); break;
-    case VK_SUBTRACT: hkeystr (hkey_str_sub); break;
-    case VK_ADD:      hkeystr (hkey_str_add); break;
-    case VK_DECIMAL:  hkeystr (hkey_str_dec); break;
-    /* Insert & Delete */
-    case VK_INSERT:   hkeystr (hkey_str_ins); break;
-    case VK_DELETE:   hkeystr (hkey_str_del); break;
-    /* Navigation */
-    case VK_HOME:     hkeystr (hkey_str_home); break;
-    case VK_END:      hkeystr (hkey_str_end);  break;
-    case VK_PRIOR:    hkeystr (hkey_str_pgup); break;
-    case VK_NEXT:     hkeystr (hkey_str_pgdn); break;
-    case VK_LEFT:     hkeystr (hkey_str_left); break;
-    case VK_UP:       hkeystr (hkey_str_up);   break;
-    case VK_RIGHT:    hkeystr (hkey_str_right);break;
-    case VK_DOWN:     hkeystr (hkey_str_down); break;
-    case VK_TAB:      hkeystr (hkey_str_tab);  break;
-    /* Backspace */
-    case VK_BACK:     hkeystr (hkey_str_bckspc); break;
-    /* Alphanumeric */
-    default: *s++ = key; *s = '\0';
-    }
-  } else {
-    if (conf) {
-      str[0] = '\0';
-    } else {
-      if (s == str) s[0] = '\0';
-      else *--s = '\0';
-    }
-  }
-#undef hkeychar
-#undef hkeystr
-}
-
-static void hotkey_failed (const HWND wnd)
-{
-  MessageBoxW (wnd, L"Couldn't set the hotkey. Check if it is being used by another application."
-  , APP_TITLE, MB_APPLMODAL | MB_ICONWARNING | MB_OK);
-}
+#define assert_ui_thread() assert (GetCurrentThreadId() == ui_thread)
 
 /* -----------------------------------------------------------------------------
 // Hotkey edit box control */
@@ -598,6 +247,51 @@ static void update_hotkey_box (const HWND wnd, const struct hotkey* const hkey)
   PostMessageW (wnd, EM_SETSEL, 0, 0);
 }
 
+static void hotkey_failed (const HWND wnd, struct hotkey* const hkey
+, const struct hotkey* const want)
+{
+  wchar_t msg[512] = L"Couldn't set the hotkey. Check if it is being used by another application.";
+  struct hotkey alt[HOTKEY_SUGGEST];
+  size_t num = 0;
+  /* Combinations are tried on a throwaway message-only window */
+  HWND const scan = CreateWindowW (L"STATIC", NULL, 0, 0, 0, 0, 0
+  , HWND_MESSAGE, NULL, app_instance, NULL);
+  if (scan != NULL) {
+    if (hotkey_scan (scan, want)) num = hotkey_suggest (want, alt);
+    DestroyWindow (scan);
+  }
+  if (num == 0) {
+    MessageBoxW (wnd, msg, APP_TITLE, MB_APPLMODAL | MB_ICONWARNING | MB_OK);
+    return;
+  }
+
+  /* Offer the nearest free combinations */
+  wchar_t str[256];
+  wcscat (msg, L"\n\nFree alternatives: ");
+  for (size_t i = 0; i != num; ++i) {
+    hotkey_to_str (str, &alt[i], false);
+    if (i != 0) wcscat (msg, L", ");
+    wcscat (msg, str);
+  }
+  hotkey_to_str (str, &alt[0], false);
+  wcscat (msg, L".\n\nUse ");
+  wcscat (msg, str);
+  wcscat (msg, L" instead?");
+  if (MessageBoxW (wnd, msg, APP_TITLE, MB_APPLMODAL | MB_ICONWARNING | MB_YESNO) != IDYES) return;
+
+  hkey->mod = alt[0].mod;
+  hkey->code = alt[0].code;
+  hkey->disabled = false;
+  if (!hotkey_register (wnd, hkey)) return;
+  config_changed();
+
+  /* Reflect it in the UI */
+  const bool border = hkey == &hkey_border;
+  SendMessageW (border ? cbox_hkey_hide_border : cbox_hkey_hide_menu
+  , BM_SETCHECK, BST_CHECKED, 0);
+  update_hotkey_box (border ? edit_hkey_hide_border : edit_hkey_hide_menu, hkey);
+}
+
 static LRESULT CALLBACK edit_hkey_wnd_proc (HWND const wnd, UINT const msg
 , WPARAM const wparam, LPARAM const lparam)
 {
@@ -611,7 +305,13 @@ static LRESULT CALLBACK edit_hkey_wnd_proc (HWND const wnd, UINT const msg
   case WM_KILLFOCUS:
     if (hkey->set) {
       hkey->set = false;
-      if (!hotkey_register (wnd_main, hkey)) hotkey_failed (wnd_main);
+      /* Failed registration brings back the last working combination */
+      const struct hotkey want = *hkey;
+      struct hotkey was = *hkey;
+      hotkey_restore (&was);
+      if (!hotkey_register (wnd_main, hkey)) hotkey_failed (wnd_main, hkey, &want);
+      if (hkey->mod != was.mod || hkey->code != was.code
+      || hkey->disabled != was.disabled) config_changed();
     } else hotkey_restore (hkey);
     update_hotkey_box (wnd, hkey);
     break;
@@ -653,163 +353,436 @@ static LRESULT CALLBACK edit_hkey_wnd_proc (HWND const wnd, UINT const msg
 }
 
 /* -----------------------------------------------------------------------------
-// Configuration file */
+// Configuration persistence */
+
+static HANDLE config_thread;
+static HANDLE config_event;
+static CRITICAL_SECTION config_lock;
+/* `CONFIG_SIZE` each: one filled in by the UI thread, one being
+// written out. Swapped under the lock, never copied. */
+static wchar_t* config_pending;
+static wchar_t* config_writing;
+static bool config_dirty; // `config_pending` is yet to be written
+static bool config_quit;
+
+static DWORD WINAPI config_thread_proc (LPVOID const param)
+{
+  for (;;) {
+    WaitForSingleObject (config_event, INFINITE);
+    EnterCriticalSection (&config_lock);
+    const bool dirty = config_dirty;
+    const bool quit = config_quit;
+    if (dirty) {
+      wchar_t* const text = config_writing;
+      config_writing = config_pending;
+      config_pending = text;
+    }
+    config_dirty = false;
+    LeaveCriticalSection (&config_lock);
+    if (dirty) config_write (conifg_path, config_writing);
+    if (quit) return 0;
+  }
+}
 
-static bool parse_hotkey (const wchar_t** const str, struct hotkey* const hkey
-, int const id)
+static void config_buffers_free (void)
 {
-#define hkeymod(s, cstr, mod) if (cstrniequ (s, cstr)) {if (hkey->code) {str[0] = s; return false;} hkey->mod = true; s += cstrlen (cstr); continue;}
-#define hkeycode(s, cstr, vk) if (cstrniequ (s, cstr)) {if (hkey->code) {str[0] = s; return false;} hkey->code = vk; s += cstrlen (cstr); continue;}
-//#define hkeychar(s, c, vk) if (s[0] == c) {if (hkey->code) {str[0] = s; return false;} hkey->code = vk; ++s; continue;}
-#define hkeychar2(s, c1, c2, vk) if (s[0] == c1 || s[0] == c2) {if (hkey->code) {str[0] = s; return false;} hkey->code = vk; ++s; continue;}
-#define hkeycharaz(s) if (iswalphab (s[0] | 0x20)) {if (hkey->code) {str[0] = s; return false;} hkey->code = s[0] & ~0x20; ++s; continue;}
-#define hkeychar09(s) if (iswdigit09 (s[0])) {if (hkey->code) {str[0] = s; return false;} hkey->code = s[0]; ++s; continue;}
-#define hkeynum09(s) if (cstrniequ (s, hkey_str_num)) {if (hkey->code || !iswdigit09 (s[cstrlen (hkey_str_num)])) {str[0] = s; return false;} hkey->code = VK_NUMPAD0 + s[0] - '0'; s += cstrlen (hkey_str_num) + 1; continue;}
-#define hkeyfunc(s) if ((s[0] | 0x20) == 'f' && iswdigit09 (s[1])) {if (hkey->code) {str[0] = s; return false;} int c = s[1] - '0'; if (iswdigit09 (s[2])) c = c * 10 + s[2] - '0'; if (c == 0 || c > 24) {str[0] = s; return false;} hkey->code = VK_F1 - 1 + c; s += 2 + (c > 9); continue;}
-  objzero (hkey);
-  hkey->id = id;
-  const wchar_t* s = str[0];
-  while (s[0] != '\0') {
-    if (cstrniequ (s, hkey_str_off)) {hkey->disabled = true; s += cstrlen (hkey_str_off); continue;}
-    /* Modifiers */
-    hkeymod (s, hkey_str_ctrl, ctrl);
-    hkeymod (s, hkey_str_alt, alt);
-    hkeymod (s, hkey_str_shift, shift);
-    hkeymod (s, hkey_str_win, win);
-    /* Numpad arithmetic operators and decimal separator */
-    hkeycode (s, hkey_str_ins, VK_DIVIDE);
-    hkeycode (s, hkey_str_mul, VK_MULTIPLY);
-    hkeycode (s, hkey_str_sub, VK_SUBTRACT);
-    hkeycode (s, hkey_str_add, VK_ADD);
-    hkeycode (s, hkey_str_dec, VK_DECIMAL);
-    /* Insert & Delete */
-    hkeycode (s, hkey_str_ins, VK_INSERT);
-    hkeycode (s, hkey_str_del, VK_DELETE);
-    /* Navigation */
-    hkeycode (s, hkey_str_home, VK_HOME);
-    hkeycode (s, hkey_str_end,  VK_END);
-    hkeycode (s, hkey_str_pgup, VK_PRIOR);
-    hkeycode (s, hkey_str_pgdn, VK_NEXT);
-    //hkeycode (s, hkey_str_left,  VK_LEFT);
-    //hkeycode (s, hkey_str_up,    VK_UP);
-    //hkeycode (s, hkey_str_right, VK_RIGHT);
-    //hkeycode (s, hkey_str_down,  VK_DOWN);
-    //hkeycode (s, hkey_str_tab,   VK_TAB);
-    /* Backspace */
-    hkeycode (s, hkey_str_bckspc, VK_BACK);
-    /* F1..F24 */
-    hkeyfunc (s);
-    /* Numpad 0..9 */
-    hkeynum09 (s);
-    /* A..Z & 0..9 */
-    hkeycharaz (s);
-    hkeychar09 (s);
-    /* ;: */hkeychar2 (s, ';', ':', VK_OEM_1);
-    /* /? */hkeychar2 (s, '/', '?', VK_OEM_2);
-    /* `~ */hkeychar2 (s, '`', '~', VK_OEM_3);
-    /* [{ */hkeychar2 (s, '[', '{', VK_OEM_4);
-    /* \| */hkeychar2 (s,'\\', '|', VK_OEM_5);
-    /* ]} */hkeychar2 (s, ']', '}', VK_OEM_6);
-    /* '" */hkeychar2 (s,'\'', '"', VK_OEM_7);
-    /* -_ */hkeychar2 (s, '-', '_', VK_OEM_MINUS);
-    /* =+ */hkeychar2 (s, '=', '+', VK_OEM_PLUS);
-    /* ,< */hkeychar2 (s, ',', '<', VK_OEM_COMMA);
-    /* .> */hkeychar2 (s, '.', '>', VK_OEM_PERIOD);
-    /* Unknown */
-    str[0] = s;
+  free (config_pending);
+  free (config_writing);
+  config_pending = config_writing = NULL;
+}
+
+static bool config_saver_start (void)
+{
+  config_pending = arrnew (wchar_t, CONFIG_SIZE);
+  config_writing = arrnew (wchar_t, CONFIG_SIZE);
+  if (config_pending == NULL || config_writing == NULL) {
+    config_buffers_free();
     return false;
   }
-  str[0] = s;
-  return hotkey_is_set (hkey);
-#undef hkeymod
-#undef hkeycode
-#undef hkeynum09
-#undef hkeychar2
-//#undef hkeychar
-#undef hkeycharaz
-#undef hkeychar09
-#undef hkeyfunc
+  config_event = CreateEventW (NULL, FALSE, FALSE, NULL);
+  if (config_event == NULL) {
+    config_buffers_free();
+    return false;
+  }
+  InitializeCriticalSection (&config_lock);
+  config_thread = CreateThread (NULL, 0, &config_thread_proc, NULL, 0, NULL);
+  if (config_thread == NULL) {
+    DeleteCriticalSection (&config_lock);
+    CloseHandle (config_event);
+    config_event = NULL;
+    config_buffers_free();
+    return false;
+  }
+  return true;
+}
+
+/* Safe to call more than once, and when never started */
+static void config_saver_stop (void)
+{
+  if (config_thread == NULL) return;
+  EnterCriticalSection (&config_lock);
+  config_quit = true;
+  LeaveCriticalSection (&config_lock);
+  SetEvent (config_event);
+  WaitForSingleObject (config_thread, INFINITE);
+  CloseHandle (config_thread);
+  CloseHandle (config_event);
+  DeleteCriticalSection (&config_lock);
+  config_buffers_free();
+  config_thread = NULL;
+  config_event = NULL;
+}
+
+/* Hand over a snapshot of current settings to the saver thread */
+static void config_flush (void)
+{
+  assert_ui_thread();
+  if (config_thread == NULL) {
+    config_save (conifg_path);
+    return;
+  }
+  /* The saver only takes the lock to swap buffers */
+  EnterCriticalSection (&config_lock);
+  config_format (config_pending);
+  config_dirty = true;
+  LeaveCriticalSection (&config_lock);
+  SetEvent (config_event);
 }
 
-static bool config_read (const wchar_t* const path)
+/* -----------------------------------------------------------------------------
+// Window layouts
+
+// Named snapshots of windows with hidden borders or menus: which
+// application and window they are, what was hidden and where they
+// were. Applying a layout matches live windows against it and hands
+// all of them to `borderless_batch()`, so the desktop recomposes
+// once. Kept in the `layouts` file next to the config, one `[name]`
+// section per layout, one window per line:
+// `<mode|-> <mask> <ex mask> <menu> <maximized> <left> <top> <right> <bottom>`
+// followed by tab separated executable path, class and title.
+// Title may end with `*` to match any title starting with it. */
+
+#define LAYOUT_MAX 128
+#define LAYOUT_NAME_MAX 64
+#define LAYOUT_TITLE_MAX 256
+#define LAYOUT_CLASS_MAX 256
+#define LAYOUT_LINE_MAX (64 + MAX_PATH + LAYOUT_CLASS_MAX + LAYOUT_TITLE_MAX)
+#define LAYOUT_DEFAULT L"default"
+
+enum layout_cmd {
+  LAYOUT_NONE,
+  LAYOUT_SAVE,
+  LAYOUT_APPLY
+};
+
+struct layout_entry {
+  wchar_t exe[MAX_PATH];
+  wchar_t cls[LAYOUT_CLASS_MAX];
+  wchar_t title[LAYOUT_TITLE_MAX];
+  bool hidden; // border, the way `mode` says
+  enum borderless_mode mode;
+  LONG mask, mask_ex;
+  bool menu;
+  bool maximized;
+  RECT rect;
+};
+
+static bool get_layout_path (wchar_t* const path)
 {
-#define read_line(line) do {\
-  if (fgetws (line, numof(line), f) == NULL) {\
-    bool const eof = feof (f);\
-    fclose (f);\
-    if (eof) return true;\
-    return false;\
-  }\
-  if (wcslen (line) != 0 && line[wcslen (line) - 1] == '\n') line[wcslen (line) - 1] = '\0';\
-} while (0)
-  struct __stat64 stat;
-  if (_wstat64 (path, &stat) == -1) return false;
-  if (stat.st_size & 1) return false;
-
-  wchar_t line[256] = {0};
-  FILE* f = _wfopen (path, L"r,ccs=UTF-16LE");
-  if (f == NULL) return false;
-
-  /* Border hide hotkey */
-  read_line (line);
-  const wchar_t* l = line;
-  if (!parse_hotkey (&l, &hkey_border, hkey_border_def.id)
-  ) hkey_border = hkey_border_def;
-
-  /* Menu hide hotkey */
-  read_line (line);
-  l = line;
-  if (!parse_hotkey (&l, &hkey_menu, hkey_menu_def.id)
-  ) hkey_menu = hkey_menu_def;
-
-  /* Border style masks */
-  read_line (line);
-  style_mask = parse_mask (line);
-  read_line (line);
-  style_ex_mask = parse_mask (line);
-
-  /* Coffee button */
-  read_line (line);
-  show_coffee = _wcsicmp (line, L"true") == 0;
-
-  fclose (f);
+  const wchar_t* const slash = wcsrchr (conifg_path, '\\');
+  const size_t dir = slash != NULL ? slash + 1 - conifg_path : 0;
+  if (dir + cstrlen (L"layouts") >= MAX_PATH) return false;
+  wcsncpy (path, conifg_path, dir);
+  wcscpy (path + dir, L"layouts");
   return true;
-#undef read_line
 }
 
-static bool config_save (const wchar_t* const path)
+static bool layout_name_valid (const wchar_t* const name)
+{
+  const size_t len = wcslen (name);
+  return len != 0 && len < LAYOUT_NAME_MAX && wcscspn (name, L"[]\t\r\n") == len;
+}
+
+static bool layout_header (const wchar_t* const line, const wchar_t* const name)
+{
+  const size_t len = wcslen (name);
+  return line[0] == '[' && _wcsnicmp (line + 1, name, len) == 0
+  && line[len + 1] == ']' && line[len + 2] == '\0';
+}
+
+static const wchar_t* layout_field (const wchar_t* const s, wchar_t* const out, size_t const size)
+{
+  const size_t len = wcscspn (s, L"\t");
+  if (s[len] != '\t' || len >= size) return NULL;
+  wcsncpy (out, s, len);
+  out[len] = '\0';
+  return s + len + 1;
+}
+
+static bool layout_parse (const wchar_t* const line, struct layout_entry* const e)
+{
+  wchar_t mode[16];
+  int menu, maximized;
+  objzero (e);
+  if (swscanf (line, L"%15ls %lx %lx %d %d %ld %ld %ld %ld", mode
+  , (unsigned long*)&e->mask, (unsigned long*)&e->mask_ex, &menu, &maximized
+  , &e->rect.left, &e->rect.top, &e->rect.right, &e->rect.bottom) != 9) return false;
+  for (int m = 0; m != BORDER_MODE_COUNT; ++m) {
+    if (_wcsicmp (mode, border_mode_str[m]) == 0) {
+      e->hidden = true;
+      e->mode = m;
+    }
+  }
+  e->menu = menu != 0;
+  e->maximized = maximized != 0;
+
+  /* Titles may contain spaces, hence tabs */
+  const wchar_t* s = wcschr (line, '\t');
+  if (s == NULL) return false;
+  if ((s = layout_field (s + 1, e->exe, numof(e->exe))) == NULL) return false;
+  if ((s = layout_field (s, e->cls, numof(e->cls))) == NULL) return false;
+  wcsncpy (e->title, s, numof(e->title) - 1);
+  return true;
+}
+
+static void layout_format (wchar_t* const line, const struct layout_entry* const e)
+{
+  _snwprintf (line, LAYOUT_LINE_MAX, L"%s 0x%lx 0x%lx %d %d %ld %ld %ld %ld\t%s\t%s\t%s\n"
+  , e->hidden ? border_mode_str[e->mode] : L"-"
+  , (unsigned long)e->mask, (unsigned long)e->mask_ex, e->menu, e->maximized
+  , (long)e->rect.left, (long)e->rect.top, (long)e->rect.right, (long)e->rect.bottom
+  , e->exe, e->cls, e->title);
+  line[LAYOUT_LINE_MAX - 1] = '\0';
+}
+
+static bool layout_capture (HWND const wnd, struct layout_entry* const e)
+{
+  objzero (e);
+  enum borderless_place place;
+  if (!borderless_window_exe (wnd, e->exe, numof(e->exe))
+  || !borderless_get_place (wnd, &place, &e->rect)) return false;
+  if (GetClassNameW (wnd, e->cls, numof(e->cls)) == 0) return false;
+  GetWindowTextW (wnd, e->title, numof(e->title));
+  for (wchar_t* c = e->title; c[0] != '\0'; ++c) {
+    if (c[0] == '\t' || c[0] == '\r' || c[0] == '\n') c[0] = ' ';
+  }
+  struct borderless_state state;
+  if (borderless_get_state (wnd, &state)) {
+    e->hidden = state.border;
+    e->mode = state.mode;
+    e->mask = state.mask;
+    e->mask_ex = state.mask_ex;
+    e->menu = state.menu;
+  }
+  e->maximized = place == BORDERLESS_PLACE_MAXIMIZED;
+  return true;
+}
+
+/* Reads entries of the named layout */
+static size_t layout_load (const wchar_t* const name
+, struct layout_entry* const entries, size_t const max)
+{
+  wchar_t path[MAX_PATH];
+  if (!get_layout_path (path)) return 0;
+  wchar_t* const text = backend->file_read (path);
+  if (text == NULL) return 0;
+
+  wchar_t line[LAYOUT_LINE_MAX];
+  const wchar_t* s = text;
+  bool section = false;
+  size_t num = 0;
+  while (num != max && (s = text_line (s, line, numof(line))) != NULL) {
+    if (line[0] == '[') section = layout_header (line, name);
+    else if (section && layout_parse (line, entries + num)) ++num;
+  }
+  free (text);
+  return num;
+}
+
+static bool text_append (wchar_t** const text, size_t* const size
+, size_t* const cap, const wchar_t* const s)
 {
-#define write_line(line) do {\
-  fputws (line, f);\
-  fputwc ('\n', f);\
-} while (0)
-  wchar_t line[256] = {0};
-  FILE* f = _wfopen (path, L"wt+,ccs=UTF-16LE");
-  if (f == NULL) return false;
-
-  /* Border hide hotkey */
-  hotkey_to_str (line, &hkey_border, true);
-  write_line (line);
-
-  /* Menu hide hotkey */
-  hotkey_to_str (line, &hkey_menu, true);
-  write_line (line);
-
-  /* Border hide style masks */
-  line[0] = '0'; line[1] = 'x';
-  _i64tow (style_mask, line + 2, 16);
-  write_line (line);
-  line[0] = '0'; line[1] = 'x';
-  _i64tow (style_ex_mask, line + 2, 16);
-  write_line (line);
-
-  /* Coffee button */
-  wcscpy (line, show_coffee ? L"true" : L"false");
-  write_line (line);
-
-  fclose (f);
+  const size_t len = wcslen (s);
+  while (size[0] + len >= cap[0]) {
+    if (!arrreserve_ ((void**)text, cap[0], cap, sizeof(wchar_t))) return false;
+  }
+  wcscpy (text[0] + size[0], s);
+  size[0] += len;
   return true;
-#undef write_line
+}
+
+/* Replaces the named layout with windows currently tracked */
+static bool layout_save (const wchar_t* const name)
+{
+  assert_ui_thread();
+  perf_begin (t);
+  wchar_t path[MAX_PATH];
+  if (!get_layout_path (path)) return false;
+
+  wchar_t* text = NULL;
+  size_t size = 0, cap = 0;
+  wchar_t line[LAYOUT_LINE_MAX];
+  bool ok = true;
+
+  /* Keep other layouts */
+  wchar_t* const old = backend->file_read (path);
+  if (old != NULL) {
+    const wchar_t* s = old;
+    bool skip = false;
+    while (ok && (s = text_line (s, line, numof(line))) != NULL) {
+      if (line[0] == '[') skip = layout_header (line, name);
+      if (!skip) ok = text_append (&text, &size, &cap, line)
+      && text_append (&text, &size, &cap, L"\n");
+    }
+    free (old);
+  }
+
+  _snwprintf (line, numof(line), L"[%s]\n", name);
+  ok = ok && text_append (&text, &size, &cap, line);
+
+  HWND wnds[LAYOUT_MAX];
+  size_t num = borderless_windows (0, NULL, true, wnds, numof(wnds));
+  if (num > numof(wnds)) num = numof(wnds);
+  size_t saved = 0;
+  for (size_t i = 0; ok && i != num; ++i) {
+    struct layout_entry e;
+    if (!layout_capture (wnds[i], &e)) continue;
+    layout_format (line, &e);
+    ok = text_append (&text, &size, &cap, line);
+    ++saved;
+  }
+
+  ok = ok && config_write (path, text);
+  free (text);
+  perf_log (t, L"layout \"%s\": %zu windows saved", name, saved);
+  return ok;
+}
+
+/* Live window for a layout entry, not matched to another entry yet */
+static HWND layout_match (const struct layout_entry* const e
+, const HWND* const taken, size_t const num, bool const by_title)
+{
+  HWND wnds[LAYOUT_MAX];
+  wchar_t exe[MAX_PATH];
+  wchar_t title[LAYOUT_TITLE_MAX];
+  size_t count = borderless_windows (0, e->cls, false, wnds, numof(wnds));
+  if (count > numof(wnds)) count = numof(wnds);
+  for (size_t i = 0; i != count; ++i) {
+    HWND const wnd = wnds[i];
+    if (wnd == wnd_main || !IsWindowVisible (wnd)) continue;
+    size_t j = 0;
+    while (j != num && taken[j] != wnd) ++j;
+    if (j != num) continue;
+    if (!borderless_window_exe (wnd, exe, numof(exe))
+    || _wcsicmp (exe, e->exe) != 0) continue;
+    if (by_title) {
+      title[0] = '\0';
+      GetWindowTextW (wnd, title, numof(title));
+      if (!pattern_match (e->title, title)) continue;
+    }
+    return wnd;
+  }
+  return NULL;
+}
+
+static bool layout_apply (const wchar_t* const name)
+{
+  assert_ui_thread();
+  perf_begin (t);
+  struct layout_entry* const entries = arrnew (struct layout_entry, LAYOUT_MAX);
+  HWND* const wnds = arrnew (HWND, LAYOUT_MAX);
+  struct borderless_op* const ops = arrnew (struct borderless_op, LAYOUT_MAX);
+  if (entries == NULL || wnds == NULL || ops == NULL) {
+    free (entries);
+    free (wnds);
+    free (ops);
+    return false;
+  }
+  const size_t num = layout_load (name, entries, LAYOUT_MAX);
+
+  /* Titles change, so windows which don't match
+  // by title get a second chance without it */
+  arrzero (wnds, num);
+  size_t matched = 0;
+  for (int pass = 0; pass != 2; ++pass) {
+    for (size_t i = 0; i != num; ++i) {
+      if (wnds[i] != NULL) continue;
+      wnds[i] = layout_match (entries + i, wnds, num, pass == 0);
+      matched += wnds[i] != NULL;
+    }
+  }
+
+  size_t count = 0;
+  for (size_t i = 0; i != num; ++i) {
+    const struct layout_entry* const e = entries + i;
+    if (wnds[i] == NULL) continue;
+    ops[count++] = (struct borderless_op){
+      .wnd = wnds[i],
+      .border = e->hidden ? BORDERLESS_HIDE : BORDERLESS_RESTORE,
+      .menu = e->menu ? BORDERLESS_HIDE : BORDERLESS_RESTORE,
+      .mask = e->mask,
+      .mask_ex = e->mask_ex,
+      .mode = e->mode,
+      .place = e->maximized ? BORDERLESS_PLACE_MAXIMIZED : BORDERLESS_PLACE_RECT,
+      .rect = e->rect
+    };
+  }
+  borderless_batch (ops, count);
+
+  free (entries);
+  free (wnds);
+  free (ops);
+  perf_log (t, L"layout \"%s\": %zu of %zu windows applied", name, matched, num);
+  return num != 0;
+}
+
+static bool layout_run (enum layout_cmd const cmd, const wchar_t* const name)
+{
+  switch (cmd) {
+  case LAYOUT_SAVE: return layout_save (name);
+  case LAYOUT_APPLY: return layout_apply (name);
+  default: return false;
+  }
+}
+
+/* Command line: `/save [<name>]` or `/apply [<name>]` */
+static enum layout_cmd layout_parse_cmd (const wchar_t* s, wchar_t* const name)
+{
+  enum layout_cmd cmd;
+  s += wcsspn (s, L" \t");
+  if (cstrniequ (s, L"/save")) {
+    cmd = LAYOUT_SAVE;
+    s += cstrlen (L"/save");
+  } else if (cstrniequ (s, L"/apply")) {
+    cmd = LAYOUT_APPLY;
+    s += cstrlen (L"/apply");
+  } else return LAYOUT_NONE;
+  if (s[0] != '\0' && s[0] != ' ' && s[0] != '\t') return LAYOUT_NONE;
+
+  s += wcsspn (s, L" \t\"");
+  size_t len = wcscspn (s, L"\"");
+  while (len != 0 && (s[len - 1] == ' ' || s[len - 1] == '\t')) --len;
+  if (len == 0) {
+    wcscpy (name, LAYOUT_DEFAULT);
+    return cmd;
+  }
+  if (len >= LAYOUT_NAME_MAX) return LAYOUT_NONE;
+  wcsncpy (name, s, len);
+  name[len] = '\0';
+  return layout_name_valid (name) ? cmd : LAYOUT_NONE;
+}
+
+/* Hand the command over to the instance already running */
+static bool layout_send (enum layout_cmd const cmd, const wchar_t* const name)
+{
+  HWND const wnd = FindWindowW (APP_CLASSNAME, NULL);
+  if (wnd == NULL) return false;
+  COPYDATASTRUCT data = {
+    .dwData = cmd,
+    .cbData = (wcslen (name) + 1) * sizeof(wchar_t),
+    .lpData = (void*)name
+  };
+  return SendMessageW (wnd, WM_COPYDATA, 0, (LPARAM)&data) != FALSE;
 }
 
 /* -----------------------------------------------------------------------------
@@ -845,15 +818,20 @@ static void tray_icon_remove (HWND const wnd)
 
 #define STR_CONFIGURE L"&Configure..."
 #define STR_DONATE L"&Donate..."
+#define STR_LAYOUT_SAVE L"&Save layout"
+#define STR_LAYOUT_APPLY L"&Apply layout"
 #define STR_EXIT L"E&xit"
 
 #define ID_CONFIGURE 1001
 #define ID_DONATE 1002
 #define ID_EXIT 1003
+#define ID_LAYOUT_SAVE 1004
+#define ID_LAYOUT_APPLY 1005
 
 #define ID_ENABLE_BORDER 2001
 #define ID_ENABLE_MENU 2002
 #define ID_DISABLE_COFFEE 2003
+#define ID_AUTO_FULLSCREEN 2004
 
 static void popup_show (HWND const wnd, HMENU const popup, const POINT* xy)
 {
@@ -893,6 +871,7 @@ static void font_set (HWND const wnd, HFONT const font)
   SendMessageW (edit_hkey_hide_border, WM_SETFONT, (WPARAM)font, MAKELPARAM(TRUE, 0));
   SendMessageW (cbox_hkey_hide_menu, WM_SETFONT, (WPARAM)font, MAKELPARAM(TRUE, 0));
   SendMessageW (edit_hkey_hide_menu, WM_SETFONT, (WPARAM)font, MAKELPARAM(TRUE, 0));
+  SendMessageW (cbox_fullscreen, WM_SETFONT, (WPARAM)font, MAKELPARAM(TRUE, 0));
   SendMessageW (cbox_coffee, WM_SETFONT, (WPARAM)font, MAKELPARAM(TRUE, 0));
 }
 
@@ -902,7 +881,8 @@ static void wnd_main_layout (int const width, int const height)
   MoveWindow (edit_hkey_hide_border, DPIX(8), DPIY(8 + 12 + 3), width - DPIX(16), DPIY(16), true);
   MoveWindow (cbox_hkey_hide_menu, DPIX(8), DPIY(8 + 12 + 3 + 16 + 6), width - DPIX(16), DPIY(12), true);
   MoveWindow (edit_hkey_hide_menu, DPIX(8), DPIY(8 + 12 + 3 + 16 + 6 + 12 + 3), width - DPIX(16), DPIY(16), true);
-  MoveWindow (cbox_coffee, DPIX(8), DPIY(8 + 12 + 3 + 16 + 6 + 12 + 3 + 16 + 6 + 3), width - DPIX(16), DPIY(16), true);
+  MoveWindow (cbox_fullscreen, DPIX(8), DPIY(8 + 12 + 3 + 16 + 6 + 12 + 3 + 16 + 6 + 3), width - DPIX(16), DPIY(16), true);
+  MoveWindow (cbox_coffee, DPIX(8), DPIY(8 + 12 + 3 + 16 + 6 + 12 + 3 + 16 + 6 + 3 + 16 + 3), width - DPIX(16), DPIY(16), true);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -934,6 +914,9 @@ static LRESULT CALLBACK wnd_main_proc (HWND const wnd, UINT const msg
     edit_hkey_hide_menu = CreateWindowW (L"EDIT", L"", WS_BORDER | WS_CHILD | WS_VISIBLE | ES_LEFT | ES_READONLY
     , 0, 0, 0, 0, wnd, NULL, NULL, NULL);
     SetWindowLongPtrW (edit_hkey_hide_menu, GWLP_WNDPROC, (LONG_PTR)&edit_hkey_wnd_proc);
+    cbox_fullscreen = CreateWindowW (L"BUTTON", L"", BS_CHECKBOX | WS_CHILD | WS_VISIBLE | WS_TABSTOP
+    , 0, 0, 0, 0, wnd, (HMENU)ID_AUTO_FULLSCREEN, NULL, NULL);
+    SetWindowTextW (cbox_fullscreen, L"Hide borders of fullscreen windows");
     cbox_coffee = CreateWindowW (L"BUTTON", L"", BS_CHECKBOX | WS_CHILD | WS_VISIBLE | WS_TABSTOP
     , 0, 0, 0, 0, wnd, (HMENU)ID_DISABLE_COFFEE, NULL, NULL);
     SetWindowTextW (cbox_coffee, L"Hide donation menu entry");
@@ -943,12 +926,15 @@ static LRESULT CALLBACK wnd_main_proc (HWND const wnd, UINT const msg
     AppendMenuW (menu_popup, MF_STRING, ID_CONFIGURE, STR_CONFIGURE);
     if (show_coffee) AppendMenuW (menu_popup, MF_STRING, ID_DONATE, STR_DONATE);
     AppendMenuW (menu_popup, MF_SEPARATOR, 0, NULL);
+    AppendMenuW (menu_popup, MF_STRING, ID_LAYOUT_SAVE, STR_LAYOUT_SAVE);
+    AppendMenuW (menu_popup, MF_STRING, ID_LAYOUT_APPLY, STR_LAYOUT_APPLY);
+    AppendMenuW (menu_popup, MF_SEPARATOR, 0, NULL);
     AppendMenuW (menu_popup, MF_STRING, ID_EXIT, STR_EXIT);
     SetMenuDefaultItem (menu_popup, ID_CONFIGURE, FALSE);
 
     if (!cbox_hkey_hide_border || !edit_hkey_hide_border
     ||  !cbox_hkey_hide_menu || !edit_hkey_hide_menu
-    ||  !cbox_coffee || !menu_popup) {
+    ||  !cbox_fullscreen || !cbox_coffee || !menu_popup) {
       err_code = EXIT_FAILURE;
       goto failure;
     }
@@ -963,9 +949,11 @@ static LRESULT CALLBACK wnd_main_proc (HWND const wnd, UINT const msg
       dpix = dpix_out;
       dpiy = dpiy_out;
     } else {
-dpi_fallback:
-      dpix = GetDeviceCaps (GetDC (GetDesktopWindow()), LOGPIXELSX);
-      dpiy = GetDeviceCaps (GetDC (GetDesktopWindow()), LOGPIXELSY);
+dpi_fallback:;
+      HDC const dc = GetDC (NULL);
+      dpix = GetDeviceCaps (dc, LOGPIXELSX);
+      dpiy = GetDeviceCaps (dc, LOGPIXELSY);
+      ReleaseDC (NULL, dc);
     }
 
     /* Get the proper font */
@@ -990,6 +978,8 @@ dpi_fallback:
     SendMessageW (cbox_hkey_hide_menu, BM_SETCHECK, hkey_menu.disabled
     ? BST_UNCHECKED : BST_CHECKED, 0);
     update_hotkey_box (edit_hkey_hide_menu, &hkey_menu);
+    SendMessageW (cbox_fullscreen, BM_SETCHECK, auto_fullscreen
+    ? BST_CHECKED : BST_UNCHECKED, 0);
     SendMessageW (cbox_coffee, BM_SETCHECK, show_coffee
     ? BST_UNCHECKED : BST_CHECKED, 0);
 
@@ -1001,7 +991,7 @@ dpi_fallback:
     int desktopWidth, desktopHeight;
     get_desktop_size (&desktopWidth, &desktopHeight);
     MoveWindow (wnd, desktopWidth - DPIX(240), desktopHeight / 2
-    , DPIX(200), DPIY(140), TRUE);
+    , DPIX(200), DPIY(160), TRUE);
 
     return 0;
   }
@@ -1025,16 +1015,41 @@ dpi_fallback:
     return 0;
   }
   /* Window layout */
-  case WM_SIZE:
+  case WM_SIZE: {
     const int width = LOWORD(lparam);
     const int height = HIWORD(lparam);
     wnd_main_layout (width, height);
     return 0;
+  }
+  case WM_TIMER:
+    if (wparam == TIMER_CONFIG) {
+      KillTimer (wnd, TIMER_CONFIG);
+      config_flush();
+    }
+    return 0;
   /* Respond to global hotkeys */
-  case WM_HOTKEY:
-    if      (wparam == hkey_border.id) remove_border (GetForegroundWindow());
-    else if (wparam == hkey_menu.id)   remove_menu (GetForegroundWindow());
+  case WM_HOTKEY: {
+    perf_begin (t);
+    HWND const fg = GetForegroundWindow();
+    if (fg == wnd) return 0;
+    if      (wparam == hkey_border.id) borderless_border (fg, BORDERLESS_TOGGLE);
+    else if (wparam == hkey_menu.id)   borderless_menu (fg, BORDERLESS_TOGGLE);
+    /* Handling time, then the whole way from the key press */
+    perf_log (t, L"hotkey %d: %lu ms since press", (int)wparam
+    , (unsigned long)(GetTickCount() - (DWORD)GetMessageTime()));
     return 0;
+  }
+  /* Layout commands from another instance */
+  case WM_COPYDATA: {
+    const COPYDATASTRUCT* const data = (COPYDATASTRUCT*)lparam;
+    wchar_t name[LAYOUT_NAME_MAX];
+    const size_t len = data->cbData / sizeof(wchar_t);
+    if (len == 0 || len > numof(name)) return FALSE;
+    arrcopy (name, (const wchar_t*)data->lpData, len);
+    name[len - 1] = '\0';
+    if (!layout_name_valid (name)) return FALSE;
+    return layout_run (data->dwData, name);
+  }
   /* Window destruction */
   case WM_CLOSE:
     ShowWindow (wnd, SW_HIDE);
@@ -1060,6 +1075,15 @@ dpi_fallback:
     case ID_DONATE:
       shell_run (DONATE_PATH);
       break;
+    case ID_LAYOUT_SAVE:
+    case ID_LAYOUT_APPLY:
+      if (!layout_run (LOWORD (wparam) == ID_LAYOUT_SAVE ? LAYOUT_SAVE : LAYOUT_APPLY
+      , LAYOUT_DEFAULT)) {
+        MessageBoxW (wnd, LOWORD (wparam) == ID_LAYOUT_SAVE
+        ? L"Couldn't save window layout." : L"No saved window layout to apply."
+        , APP_TITLE, MB_APPLMODAL | MB_ICONWARNING | MB_OK);
+      }
+      break;
     case ID_EXIT:
       SendMessageW (wnd, WM_CLOSE, 0, 0);
 failure:
@@ -1070,7 +1094,7 @@ failure:
       if (hkey_border.disabled) {
         hkey_border.disabled = false;
         if (!hotkey_register (wnd, &hkey_border)) {
-          hotkey_failed (wnd);
+          hotkey_failed (wnd, &hkey_border, &hkey_border);
           break;
         }
         SendMessageW (cbox_hkey_hide_border, BM_SETCHECK, BST_CHECKED, 0);
@@ -1079,12 +1103,13 @@ failure:
         hkey_border.disabled = true;
         SendMessageW (cbox_hkey_hide_border, BM_SETCHECK, BST_UNCHECKED, 0);
       }
+      config_changed();
       break;
     case ID_ENABLE_MENU:
       if (hkey_menu.disabled) {
         hkey_menu.disabled = false;
         if (!hotkey_register (wnd, &hkey_menu)) {
-          hotkey_failed (wnd);
+          hotkey_failed (wnd, &hkey_menu, &hkey_menu);
           break;
         }
         SendMessageW (cbox_hkey_hide_menu, BM_SETCHECK, BST_CHECKED, 0);
@@ -1093,6 +1118,14 @@ failure:
         hkey_menu.disabled = true;
         SendMessageW (cbox_hkey_hide_menu, BM_SETCHECK, BST_UNCHECKED, 0);
       }
+      config_changed();
+      break;
+    case ID_AUTO_FULLSCREEN:
+      if (!borderless_set_fullscreen (!auto_fullscreen)) break;
+      auto_fullscreen = !auto_fullscreen;
+      SendMessageW (cbox_fullscreen, BM_SETCHECK, auto_fullscreen
+      ? BST_CHECKED : BST_UNCHECKED, 0);
+      config_changed();
       break;
     case ID_DISABLE_COFFEE:
       if (show_coffee) {
@@ -1104,6 +1137,7 @@ failure:
         SendMessageW (cbox_coffee, BM_SETCHECK, BST_UNCHECKED, 0);
         InsertMenuW (menu_popup, 1, MF_STRING | MF_BYPOSITION, ID_DONATE, L"&Donate...");
       }
+      config_changed();
       break;
     }
     return 0;
@@ -1165,15 +1199,25 @@ int WINAPI wWinMain (HINSTANCE const inst, HINSTANCE const prev
 #endif
 
   app_instance = inst;
+  ui_thread = GetCurrentThreadId();
   if (CoInitializeEx (NULL, COINIT_APARTMENTTHREADED
   | COINIT_DISABLE_OLE1DDE) != S_OK) return EXIT_FAILURE;
 
+  /* Layout command, if any */
+  wchar_t layout_name[LAYOUT_NAME_MAX];
+  const enum layout_cmd layout_cmd = layout_parse_cmd (cmd, layout_name);
+
   /* Allow only one instance */
   if ((mutex = CreateMutexW (NULL, TRUE, APP_ID)) == NULL) {
     return EXIT_FAILURE;
   }
 
   if (GetLastError() == ERROR_ALREADY_EXISTS) {
+    if (layout_cmd != LAYOUT_NONE) {
+      const bool ok = layout_send (layout_cmd, layout_name);
+      CloseHandle (mutex);
+      return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 failure_early:
     CloseHandle (mutex);
     return EXIT_FAILURE;
@@ -1200,9 +1244,21 @@ failure_early:
   }
   first_run = !config_read (conifg_path);
 
+  /* Start tracking windows */
+  if (!borderless_init (&(struct borderless_config){
+    .size = sizeof(struct borderless_config),
+    .mask = style_mask,
+    .mask_ex = style_ex_mask,
+    .mode = border_mode
+  })) goto failure_early;
+  if (auto_fullscreen && !borderless_set_fullscreen (true)) auto_fullscreen = false;
+
   hotkey_save (&hkey_border);
   hotkey_save (&hkey_menu);
 
+  /* Failing that, settings are saved right on the UI thread */
+  config_saver_start();
+
   /* Create main window */
   WNDCLASSEX wclx = {
     .cbSize      = sizeof (wclx),
@@ -1226,6 +1282,7 @@ failure_early:
   , WS_CAPTION | WS_SYSMENU | WS_MINIMIZEBOX | (WS_VISIBLE * first_run)
   , CW_USEDEFAULT, CW_USEDEFAULT, 0, 0, NULL, NULL, inst, NULL);
   if (wnd_main == NULL) goto failure;
+  if (layout_cmd != LAYOUT_NONE) layout_run (layout_cmd, layout_name);
 
   /* Enter GUI message loop */
   MSG msg;
@@ -1250,11 +1307,14 @@ failure_early:
   }
 
   /* Write configuration */
+  config_saver_stop();
   config_save (conifg_path);
 
   /* Free remaining resources */
 failure:
+  config_saver_stop();
   UnregisterClassW (APP_CLASSNAME, inst);
+  borderless_shutdown();
   FreeLibrary (lib_shcore);
   CloseHandle (mutex);
 
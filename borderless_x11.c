@@ -0,0 +1,96 @@
+/* =============================================================================
+// BORDERless for X11 desktops
+//
+// The same hotkeys and configuration file as the Windows app, without
+// the settings window: edit `$XDG_CONFIG_HOME/borderless.cfg` (or
+// `~/.config/borderless.cfg`) and restart. Runs until interrupted.
+// Needs a window manager which keeps `_NET_CLIENT_LIST` and honors
+// `_MOTIF_WM_HINTS`. See `backend_xcb.c`, `build.sh x11`.
+// -------------------------------------------------------------------------- */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <locale.h>
+#include <signal.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+#include "config.h"
+
+static volatile sig_atomic_t quit;
+static wchar_t config_path[1024];
+
+static void on_signal (int const sig)
+{
+  quit = 1;
+}
+
+static bool get_config_path (void)
+{
+  const char* const xdg = getenv ("XDG_CONFIG_HOME");
+  const char* const home = getenv ("HOME");
+  int len;
+  if (xdg != NULL && xdg[0] != '\0') {
+    len = swprintf (config_path, numof(config_path), L"%s/borderless.cfg", xdg);
+  } else if (home != NULL) {
+    len = swprintf (config_path, numof(config_path), L"%s/.config/borderless.cfg", home);
+  } else return false;
+  return len > 0;
+}
+
+static void on_hotkey (int const id)
+{
+  HWND const fg = backend_xcb_active();
+  if (fg == NULL) return;
+  if      (id == hkey_border.id) borderless_border (fg, BORDERLESS_TOGGLE);
+  else if (id == hkey_menu.id)   borderless_menu (fg, BORDERLESS_TOGGLE);
+}
+
+int main (void)
+{
+  setlocale (LC_ALL, "");
+  borderless_set_backend (&backend_xcb);
+
+  /* Read configuration */
+  hkey_border = hkey_border_def;
+  hkey_menu = hkey_menu_def;
+  if (!get_config_path()) return EXIT_FAILURE;
+  const bool first_run = !config_read (config_path);
+
+  /* Start tracking windows */
+  if (!borderless_init (&(struct borderless_config){
+    .size = sizeof(struct borderless_config),
+    .mask = style_mask,
+    .mask_ex = style_ex_mask,
+    .mode = border_mode
+  })) {
+    fputs ("borderless: cannot connect to the X server\n", stderr);
+    return EXIT_FAILURE;
+  }
+  if (auto_fullscreen && !borderless_set_fullscreen (true)) auto_fullscreen = false;
+
+  hotkey_save (&hkey_border);
+  hotkey_save (&hkey_menu);
+  if (!hotkey_register (NULL, &hkey_border)) fputs ("borderless: border hotkey is taken\n", stderr);
+  if (!hotkey_register (NULL, &hkey_menu))   fputs ("borderless: menu hotkey is taken\n", stderr);
+
+  signal (SIGINT, &on_signal);
+  signal (SIGTERM, &on_signal);
+  while (!quit && backend_xcb_wait (-1, &on_hotkey));
+
+  hotkey_unregister (NULL, &hkey_border);
+  hotkey_unregister (NULL, &hkey_menu);
+  /* Write the defaults out for editing */
+  if (first_run) config_save (config_path);
+  borderless_shutdown();
+  return EXIT_SUCCESS;
+}
@@ -4,8 +4,21 @@ cd /d "%~dp0"
 :: Compile resources
 rc borderless.rc > nul
 
+:: Build the library: static for the app, shared for everyone else
+clang -O2 -c %* libborderless.c -o libborderless.o
+clang -O2 -c %* backend_win32.c -o backend_win32.o
+llvm-ar rcs libborderless.lib libborderless.o backend_win32.o
+clang -O2 -shared -DBORDERLESS_EXPORTS %* libborderless.c backend_win32.c -o libborderless.dll -Wl,/implib:libborderless.dll.lib -luser32 -lgdi32
+
 :: Build the executable
-clang -O2 -mwindows -municode %* borderless.c borderless.res -o borderless.exe -luser32 -lgdi32 -lshell32 -lole32 -Wno-deprecated-declarations
+clang -O2 -mwindows -municode %* borderless.c config.c borderless.res libborderless.lib -o borderless.exe -luser32 -lgdi32 -lshell32 -lole32 -Wno-deprecated-declarations
+
+:: Build the hook module: hook.def keeps hook_proc undecorated on 32-bit too
+clang -O2 -shared %* hook.c -o borderless_hook.dll -Wl,/DEF:hook.def -luser32 -lcomctl32
+
+:: Build the latency harness, see bench/latency.c
+clang -O2 -mwindows -municode %* bench/target.c -o bench/target.exe -luser32 -lgdi32
+clang -O2 -I. %* bench/latency.c -o bench/latency.exe -luser32
 
 :: Embed manifest
 mt -nologo -manifest borderless.exe.manifest -outputresource:"borderless.exe;1"
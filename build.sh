@@ -0,0 +1,55 @@
+#!/bin/sh
+# Cross-compile with MinGW-w64, e.g. to run under Wine.
+# Pass `-DNDEBUG` for a release build, as with `build.bat`.
+# `./build.sh bench` builds the benchmarks for this system instead,
+# `./build.sh x11` the app for X11 desktops, see `borderless_x11.c`.
+set -e
+cd "$(dirname "$0")"
+
+# Benchmarks against the in-memory backend, see `bench/bench.c`
+if [ "$1" = bench ]; then
+  shift
+  ${HOSTCC:-cc} -O2 -DNDEBUG -I. "$@" bench/bench.c bench/fake.c backend_posix.c libborderless.c config.c \
+    -o bench/bench
+  ${HOSTCC:-cc} -O2 -DNDEBUG -I. "$@" bench/crash.c bench/fake.c backend_posix.c libborderless.c config.c \
+    -o bench/crash
+  ${HOSTCC:-cc} -O2 -DNDEBUG -I. "$@" bench/soak.c bench/fake.c backend_posix.c libborderless.c config.c \
+    -o bench/soak
+  exit
+fi
+
+# The app and its test against an X server, with XCB
+if [ "$1" = x11 ]; then
+  shift
+  ${HOSTCC:-cc} -O2 -DNDEBUG -DBORDERLESS_XCB -I. "$@" borderless_x11.c backend_xcb.c backend_posix.c \
+    libborderless.c config.c -o borderless -lxcb
+  ${HOSTCC:-cc} -O2 -DNDEBUG -DBORDERLESS_XCB -I. "$@" bench/xcb_test.c backend_xcb.c backend_posix.c \
+    libborderless.c -o bench/xcb_test -lxcb
+  exit
+fi
+
+CC=${CC:-x86_64-w64-mingw32-gcc}
+AR=${AR:-x86_64-w64-mingw32-ar}
+WINDRES=${WINDRES:-x86_64-w64-mingw32-windres}
+
+# Compile resources and manifest
+"$WINDRES" borderless.rc -O coff -o borderless.res.o
+echo '1 24 "borderless.exe.manifest"' | "$WINDRES" -O coff -o borderless.manifest.o
+
+# Build the library: static for the app, shared for everyone else
+"$CC" -O2 -c "$@" libborderless.c -o libborderless.o
+"$CC" -O2 -c "$@" backend_win32.c -o backend_win32.o
+"$AR" rcs libborderless.a libborderless.o backend_win32.o
+"$CC" -O2 -shared -DBORDERLESS_EXPORTS "$@" libborderless.c backend_win32.c -o libborderless.dll \
+  -Wl,--out-implib,libborderless.dll.a -luser32 -lgdi32
+
+# Build the executable
+"$CC" -O2 -mwindows -municode "$@" borderless.c config.c borderless.res.o borderless.manifest.o \
+  libborderless.a -o borderless.exe -luser32 -lgdi32 -lshell32 -lole32 -Wno-deprecated-declarations
+
+# Build the hook module: `hook_proc` undecorated on 32-bit too
+"$CC" -O2 -shared -Wl,--kill-at "$@" hook.c -o borderless_hook.dll -luser32 -lcomctl32
+
+# Build the latency harness, see `bench/wine.sh`
+"$CC" -O2 -mwindows -municode "$@" bench/target.c -o bench/target.exe -luser32 -lgdi32
+"$CC" -O2 -I. "$@" bench/latency.c -o bench/latency.exe -luser32
@@ -0,0 +1,84 @@
+/* =============================================================================
+// BORDERless: helpers shared by the app and the library
+//
+// Private: not a part of the library API.
+// -------------------------------------------------------------------------- */
+
+#ifndef BORDERLESS_COMMON_H
+#define BORDERLESS_COMMON_H
+
+/* -----------------------------------------------------------------------------
+// C array */
+#define numof(arr) (sizeof(arr) / sizeof(arr[0]))
+#define arrnew(type, num) malloc ((num) * sizeof(type))
+#define arrsize(arr, num) ((num) * sizeof((arr)[0]))
+#define arrnewsize(arr, num) realloc (arr, arrsize (arr, num))
+#define arrcopy(dst, src, num) memcpy (dst, src, arrsize (dst, num))
+#define arrmove(dst, src, num) memmove (dst, src, arrsize (dst, num))
+#define arrzero(arr, num) memset (arr, 0, arrsize (arr, num))
+#define objzero(obj) arrzero (obj, 1)
+
+/* Growable array: make room for one more item,
+// doubling capacity when it runs out */
+#define arrreserve(arr, num, cap) arrreserve_ ((void**)&(arr), num, &(cap), sizeof((arr)[0]))
+
+static inline bool arrreserve_ (void** const arr, size_t const num, size_t* const cap
+, size_t const size)
+{
+  if (num < cap[0]) return true;
+  const size_t newcap = cap[0] != 0 ? cap[0] * 2 : 8;
+  void* const newptr = realloc (arr[0], newcap * size);
+  if (newptr == NULL) return false;
+  arr[0] = newptr;
+  cap[0] = newcap;
+  return true;
+}
+
+/* C constant string */
+#define cstrlen(str) (sizeof(str) / sizeof(str[0]) - 1)
+#define cstrniequ(str, cstr) (_wcsnicmp (str, cstr, cstrlen(cstr)) == 0)
+
+/* Additional character tests */
+#define iswalphab(c) ((c) >= 'a' && (c) <= 'z')
+#define iswdigit09(c) ((c) >= '0' && (c) <= '9')
+
+/* Case-insensitive match, or prefix match if `pattern` ends with `*` */
+static inline bool pattern_match (const wchar_t* const pattern, const wchar_t* const str)
+{
+  /* Cheap test first: most lookups fail on it */
+  if (pattern[0] != '*' && (pattern[0] | 0x20) != (str[0] | 0x20)) return false;
+  const size_t len = wcslen (pattern);
+  if (len != 0 && pattern[len - 1] == '*') return _wcsnicmp (pattern, str, len - 1) == 0;
+  return _wcsicmp (pattern, str) == 0;
+}
+
+/* -----------------------------------------------------------------------------
+// Timing: debug builds report how long the bulk operations take */
+#ifndef NDEBUG
+#ifdef _WIN32
+static inline double perf_now (void)
+{
+  LARGE_INTEGER freq, now;
+  QueryPerformanceFrequency (&freq);
+  QueryPerformanceCounter (&now);
+  return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+}
+#else
+#include <time.h>
+
+static inline double perf_now (void)
+{
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1000000.0;
+}
+#endif
+
+#define perf_begin(t) const double t = perf_now()
+#define perf_log(t, fmt, ...) wprintf (L"[%.3f ms] " fmt L"\n", perf_now() - (t), ##__VA_ARGS__)
+#else
+#define perf_begin(t)
+#define perf_log(t, fmt, ...) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,545 @@
+/* =============================================================================
+// BORDERless: settings, hotkeys and the configuration file
+//
+// Hotkeys are kept as the user set them and as they last worked,
+// and get written to and read from the configuration file,
+// see `config.h`.
+// -------------------------------------------------------------------------- */
+
+#ifndef UNICODE
+/* Enable Unicode in WinAPI */
+#define UNICODE
+#endif
+
+#ifndef _UNICODE
+/* Enable Unicode in C runtime */
+#define _UNICODE
+#endif
+
+#ifndef _WIN32_WINNT
+/* Enable Windows 7 features */
+#define _WIN32_WINNT 0x0601
+#endif
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <wchar.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+#include "config.h"
+
+/* -----------------------------------------------------------------------------
+// Settings */
+
+bool show_coffee = true;
+bool auto_fullscreen;
+
+/* Default masks for WinAPI window styles */
+LONG style_mask = WS_CAPTION | WS_MAXIMIZEBOX | WS_MINIMIZEBOX
+| WS_SYSMENU | WS_THICKFRAME;
+LONG style_ex_mask = WS_EX_CLIENTEDGE | WS_EX_STATICEDGE
+| WS_EX_WINDOWEDGE | WS_EX_DLGMODALFRAME;
+
+enum borderless_mode border_mode = BORDERLESS_MODE_MASK;
+
+const wchar_t* const border_mode_str[BORDER_MODE_COUNT] = {
+  [BORDERLESS_MODE_MASK]   = L"mask",
+  [BORDERLESS_MODE_DWM]    = L"dwm",
+  [BORDERLESS_MODE_REGION] = L"region"
+};
+
+/* -----------------------------------------------------------------------------
+// Utilities */
+#define parse_mask parse_hex
+
+static inline unsigned long parse_hex (const wchar_t* const str)
+{
+  wchar_t** end = (wchar_t**)&str;
+  return wcstoul (str, end, 16);
+}
+
+/* -----------------------------------------------------------------------------
+// Hotkey */
+
+static const wchar_t hkey_str_off[]    = L"Off+";
+static const wchar_t hkey_str_ctrl[]   = L"Ctrl+";
+static const wchar_t hkey_str_alt[]    = L"Alt+";
+static const wchar_t hkey_str_shift[]  = L"Shift+";
+static const wchar_t hkey_str_win[]    = L"Win+";
+static const wchar_t hkey_str_ins[]    = L"Insert";
+static const wchar_t hkey_str_del[]    = L"Delete";
+static const wchar_t hkey_str_home[]   = L"Home";
+static const wchar_t hkey_str_end[]    = L"End";
+static const wchar_t hkey_str_pgup[]   = L"PageUp";
+static const wchar_t hkey_str_pgdn[]   = L"PageDown";
+static const wchar_t hkey_str_num[]    = L"Num";
+static const wchar_t hkey_str_div[]    = L"Divide";
+static const wchar_t hkey_str_mul[]    = L"Multiply";
+static const wchar_t hkey_str_sub[]    = L"Subtract";
+static const wchar_t hkey_str_add[]    = L"Add";
+static const wchar_t hkey_str_dec[]    = L"Decimal";
+static const wchar_t hkey_str_left[]   = L"Left";
+static const wchar_t hkey_str_up[]     = L"Up";
+static const wchar_t hkey_str_right[]  = L"Right";
+static const wchar_t hkey_str_down[]   = L"Down";
+static const wchar_t hkey_str_tab[]    = L"Tab";
+static const wchar_t hkey_str_bckspc[] = L"Backspace";
+
+struct hotkey hkey_border;
+struct hotkey hkey_border_def = (struct hotkey){
+  .ctrl = false, .alt = true, .shift = false, .win = false,
+  .code = 'B', .id = 1
+};
+struct hotkey hkey_menu;
+struct hotkey hkey_menu_def = (struct hotkey){
+  .ctrl = false, .alt = true, .shift = false, .win = false,
+  .code = 'M', .id = 2
+};
+
+bool hotkey_unregister (HWND const wnd, struct hotkey* const hkey)
+{
+  if (hkey->reg) {
+    if (!backend->unregister_hotkey (wnd, hkey->id)) return false;
+    hkey->reg = false;
+  }
+  return true;
+}
+
+bool hotkey_register (HWND const wnd, struct hotkey* const hkey)
+{
+  if (!hotkey_unregister (wnd, hkey)) return false;
+  if (hkey->disabled || hkey->code == 0) return true;
+  if (!backend->register_hotkey (wnd, hkey->id, hotkey_mod_to_int (hkey), hkey->code)) {
+    if (hkey->wcode != 0) {
+      if (hkey->wcode != hkey->code || hkey->wmod != hkey->mod) {
+        hotkey_restore (hkey);
+        if (!backend->register_hotkey (wnd, hkey->id, hotkey_mod_to_int (hkey), hkey->code)) {
+          hkey->disabled = true;
+        } else hkey->reg = true;
+      } else hkey->disabled = true;
+    }
+    return false;
+  }
+  /* Remember keystroke as it was successfully registered */
+  hotkey_save (hkey);
+  hkey->reg = true;
+  return true;
+}
+
+void hotkey_to_str (wchar_t* const str, const struct hotkey* const hkey
+, const bool conf)
+{
+#define hkeychar(c) *s++ = c; s[0] = '\0'
+#define hkeystr(cstr) wcscpy (s, cstr); s += cstrlen(cstr)
+  wchar_t* s = str;
+  if (conf && hkey->disabled) {wcscpy (s, hkey_str_off); s += cstrlen(hkey_str_off);}
+  /* Modifiers */
+  if (hkey->ctrl)  {wcscpy (s, hkey_str_ctrl);  s += cstrlen (hkey_str_ctrl);}
+  if (hkey->alt)   {wcscpy (s, hkey_str_alt);   s += cstrlen (hkey_str_alt);}
+  if (hkey->shift) {wcscpy (s, hkey_str_shift); s += cstrlen (hkey_str_shift);}
+  if (hkey->win)   {wcscpy (s, hkey_str_win);   s += cstrlen (hkey_str_win);}
+  /* Actual key */
+  if (hkey->code) {
+    const UINT key = hkey->code;
+    /* Functional */
+    if      (key >= 0x70 && key <= 0x87) {*s++ = 'F'; _snwprintf (s, 4, L"%u", key - 0x70 + 1);}
+    /* Numpad */
+    else if (key >= 0x60 && key <= 0x69) {wcscpy (s, hkey_str_num); s += cstrlen(hkey_str_num); _snwprintf (s, 4, L"%u", key - 0x60);}
+    else switch (key) {
+    /* ;: */case VK_OEM_1: hkeychar (';'); break;
+    /* /? */case VK_OEM_2: hkeychar ('/'); break;
+    /* `~ */case VK_OEM_3: hkeychar ('`'); break;
+    /* [{ */case VK_OEM_4: hkeychar ('['); break;
+    /* \| */case VK_OEM_5: hkeychar('\\'); break;
+    /* ]} */case VK_OEM_6: hkeychar (']'); break;
+    /* '" */case VK_OEM_7: hkeychar('\''); break;
+    /* -_ */case VK_OEM_MINUS:  hkeychar ('-'); break;
+    /* =+ */case VK_OEM_PLUS:   hkeychar ('='); break;
+    /* ,< */case VK_OEM_COMMA:  hkeychar (','); break;
+    /* .> */case VK_OEM_PERIOD: hkeychar ('.'); break;
+    /* Numpad arithmetic operators and decimal separator */
+    case VK_DIVIDE:   hkeystr (hkey_str_div); break;
+    case VK_MULTIPLY: hkeystr (hkey_str_mul); break;
+    case VK_SUBTRACT: hkeystr (hkey_str_sub); break;
+    case VK_ADD:      hkeystr (hkey_str_add); break;
+    case VK_DECIMAL:  hkeystr (hkey_str_dec); break;
+    /* Insert & Delete */
+    case VK_INSERT:   hkeystr (hkey_str_ins); break;
+    case VK_DELETE:   hkeystr (hkey_str_del); break;
+    /* Navigation */
+    case VK_HOME:     hkeystr (hkey_str_home); break;
+    case VK_END:      hkeystr (hkey_str_end);  break;
+    case VK_PRIOR:    hkeystr (hkey_str_pgup); break;
+    case VK_NEXT:     hkeystr (hkey_str_pgdn); break;
+    case VK_LEFT:     hkeystr (hkey_str_left); break;
+    case VK_UP:       hkeystr (hkey_str_up);   break;
+    case VK_RIGHT:    hkeystr (hkey_str_right);break;
+    case VK_DOWN:     hkeystr (hkey_str_down); break;
+    case VK_TAB:      hkeystr (hkey_str_tab);  break;
+    /* Backspace */
+    case VK_BACK:     hkeystr (hkey_str_bckspc); break;
+    /* Alphanumeric */
+    default: *s++ = key; *s = '\0';
+    }
+  } else {
+    if (conf) {
+      str[0] = '\0';
+    } else {
+      if (s == str) s[0] = '\0';
+      else *--s = '\0';
+    }
+  }
+#undef hkeychar
+#undef hkeystr
+}
+
+bool parse_hotkey (const wchar_t** const str, struct hotkey* const hkey
+, int const id)
+{
+#define hkeymod(s, cstr, mod) if (cstrniequ (s, cstr)) {if (hkey->code) {str[0] = s; return false;} hkey->mod = true; s += cstrlen (cstr); continue;}
+#define hkeycode(s, cstr, vk) if (cstrniequ (s, cstr)) {if (hkey->code) {str[0] = s; return false;} hkey->code = vk; s += cstrlen (cstr); continue;}
+//#define hkeychar(s, c, vk) if (s[0] == c) {if (hkey->code) {str[0] = s; return false;} hkey->code = vk; ++s; continue;}
+#define hkeychar2(s, c1, c2, vk) if (s[0] == c1 || s[0] == c2) {if (hkey->code) {str[0] = s; return false;} hkey->code = vk; ++s; continue;}
+#define hkeycharaz(s) if (iswalphab (s[0] | 0x20)) {if (hkey->code) {str[0] = s; return false;} hkey->code = s[0] & ~0x20; ++s; continue;}
+#define hkeychar09(s) if (iswdigit09 (s[0])) {if (hkey->code) {str[0] = s; return false;} hkey->code = s[0]; ++s; continue;}
+#define hkeynum09(s) if (cstrniequ (s, hkey_str_num)) {if (hkey->code || !iswdigit09 (s[cstrlen (hkey_str_num)])) {str[0] = s; return false;} hkey->code = VK_NUMPAD0 + s[0] - '0'; s += cstrlen (hkey_str_num) + 1; continue;}
+#define hkeyfunc(s) if ((s[0] | 0x20) == 'f' && iswdigit09 (s[1])) {if (hkey->code) {str[0] = s; return false;} int c = s[1] - '0'; if (iswdigit09 (s[2])) c = c * 10 + s[2] - '0'; if (c == 0 || c > 24) {str[0] = s; return false;} hkey->code = VK_F1 - 1 + c; s += 2 + (c > 9); continue;}
+  objzero (hkey);
+  hkey->id = id;
+  const wchar_t* s = str[0];
+  while (s[0] != '\0') {
+    if (cstrniequ (s, hkey_str_off)) {hkey->disabled = true; s += cstrlen (hkey_str_off); continue;}
+    /* Modifiers */
+    hkeymod (s, hkey_str_ctrl, ctrl);
+    hkeymod (s, hkey_str_alt, alt);
+    hkeymod (s, hkey_str_shift, shift);
+    hkeymod (s, hkey_str_win, win);
+    /* Numpad arithmetic operators and decimal separator */
+    hkeycode (s, hkey_str_ins, VK_DIVIDE);
+    hkeycode (s, hkey_str_mul, VK_MULTIPLY);
+    hkeycode (s, hkey_str_sub, VK_SUBTRACT);
+    hkeycode (s, hkey_str_add, VK_ADD);
+    hkeycode (s, hkey_str_dec, VK_DECIMAL);
+    /* Insert & Delete */
+    hkeycode (s, hkey_str_ins, VK_INSERT);
+    hkeycode (s, hkey_str_del, VK_DELETE);
+    /* Navigation */
+    hkeycode (s, hkey_str_home, VK_HOME);
+    hkeycode (s, hkey_str_end,  VK_END);
+    hkeycode (s, hkey_str_pgup, VK_PRIOR);
+    hkeycode (s, hkey_str_pgdn, VK_NEXT);
+    //hkeycode (s, hkey_str_left,  VK_LEFT);
+    //hkeycode (s, hkey_str_up,    VK_UP);
+    //hkeycode (s, hkey_str_right, VK_RIGHT);
+    //hkeycode (s, hkey_str_down,  VK_DOWN);
+    //hkeycode (s, hkey_str_tab,   VK_TAB);
+    /* Backspace */
+    hkeycode (s, hkey_str_bckspc, VK_BACK);
+    /* F1..F24 */
+    hkeyfunc (s);
+    /* Numpad 0..9 */
+    hkeynum09 (s);
+    /* A..Z & 0..9 */
+    hkeycharaz (s);
+    hkeychar09 (s);
+    /* ;: */hkeychar2 (s, ';', ':', VK_OEM_1);
+    /* /? */hkeychar2 (s, '/', '?', VK_OEM_2);
+    /* `~ */hkeychar2 (s, '`', '~', VK_OEM_3);
+    /* [{ */hkeychar2 (s, '[', '{', VK_OEM_4);
+    /* \| */hkeychar2 (s,'\\', '|', VK_OEM_5);
+    /* ]} */hkeychar2 (s, ']', '}', VK_OEM_6);
+    /* '" */hkeychar2 (s,'\'', '"', VK_OEM_7);
+    /* -_ */hkeychar2 (s, '-', '_', VK_OEM_MINUS);
+    /* =+ */hkeychar2 (s, '=', '+', VK_OEM_PLUS);
+    /* ,< */hkeychar2 (s, ',', '<', VK_OEM_COMMA);
+    /* .> */hkeychar2 (s, '.', '>', VK_OEM_PERIOD);
+    /* Unknown */
+    str[0] = s;
+    return false;
+  }
+  str[0] = s;
+  return hotkey_is_set (hkey);
+#undef hkeymod
+#undef hkeycode
+#undef hkeynum09
+#undef hkeychar2
+//#undef hkeychar
+#undef hkeycharaz
+#undef hkeychar09
+#undef hkeyfunc
+}
+
+/* -----------------------------------------------------------------------------
+// Free hotkey discovery */
+
+#define HOTKEY_MODS 16 // every combination of Ctrl, Alt, Shift and Win
+#define HOTKEY_KEYS_MAX 128
+#define HOTKEY_SCAN_ID 0xbfff
+
+static bool hotkey_taken[HOTKEY_MODS][256];
+
+/* Same keys as accepted by `update_hotkey()` */
+static size_t hotkey_keys (UINT* const keys)
+{
+  static const BYTE extra[] = {
+    VK_OEM_1, VK_OEM_2, VK_OEM_3, VK_OEM_4, VK_OEM_5, VK_OEM_6, VK_OEM_7
+  , VK_OEM_MINUS, VK_OEM_PLUS, VK_OEM_COMMA, VK_OEM_PERIOD
+  , VK_MULTIPLY, VK_DIVIDE, VK_SUBTRACT, VK_ADD, VK_DECIMAL
+  , VK_INSERT, VK_DELETE, VK_HOME, VK_END, VK_PRIOR, VK_NEXT, VK_BACK
+  };
+  size_t n = 0;
+  for (UINT k = 0x41; k <= 0x5a; ++k) keys[n++] = k; // A..Z
+  for (UINT k = 0x30; k <= 0x39; ++k) keys[n++] = k; // 0..9
+  for (UINT k = 0x60; k <= 0x69; ++k) keys[n++] = k; // Numpad 0..9
+  for (UINT k = 0x70; k <= 0x87; ++k) keys[n++] = k; // F1..F24
+  for (size_t i = 0; i != numof(extra); ++i) keys[n++] = extra[i];
+  assert (n <= HOTKEY_KEYS_MAX);
+  return n;
+}
+
+static inline int hotkey_mod_index (const struct hotkey* const hkey)
+{
+  return (hkey->ctrl != 0) | ((hkey->alt != 0) << 1)
+  | ((hkey->shift != 0) << 2) | ((hkey->win != 0) << 3);
+}
+
+static inline void hotkey_mod_from_index (struct hotkey* const hkey, int const m)
+{
+  hkey->ctrl  = (m & 1) != 0;
+  hkey->alt   = (m & 2) != 0;
+  hkey->shift = (m & 4) != 0;
+  hkey->win   = (m & 8) != 0;
+}
+
+/* Find out which combinations are free by registering
+// and immediately unregistering each of them */
+static void hotkey_probe (HWND const wnd, int const m, UINT const code)
+{
+  struct hotkey h = {.code = code};
+  hotkey_mod_from_index (&h, m);
+  if (!hotkey_is_set (&h)) {
+    hotkey_taken[m][code] = true;
+    return;
+  }
+  if (backend->register_hotkey (wnd, HOTKEY_SCAN_ID, hotkey_mod_to_int (&h), code)) {
+    backend->unregister_hotkey (wnd, HOTKEY_SCAN_ID);
+    hotkey_taken[m][code] = false;
+  } else hotkey_taken[m][code] = true;
+}
+
+/* Only what `hotkey_suggest()` can offer for `want`: its key with
+// other modifiers and its modifiers with other keys. Every
+// combination costs a round trip to the system. */
+bool hotkey_scan (HWND const wnd, const struct hotkey* const want)
+{
+  perf_begin (t);
+  UINT keys[HOTKEY_KEYS_MAX];
+  const size_t n = hotkey_keys (keys);
+  const int want_mod = hotkey_mod_index (want);
+  memset (hotkey_taken, true, sizeof(hotkey_taken));
+  for (int m = 0; m != HOTKEY_MODS; ++m) {
+    if (want->code < numof(hotkey_taken[m])) hotkey_probe (wnd, m, want->code);
+  }
+  for (size_t i = 0; i != n; ++i) {
+    if (keys[i] != want->code) hotkey_probe (wnd, want_mod, keys[i]);
+  }
+  perf_log (t, L"scanned %zu hotkeys", HOTKEY_MODS + n - 1);
+  return true;
+}
+
+/* Pick free combinations nearest to the wanted one: either the same key
+// with the fewest modifiers changed, or the same modifiers with a key
+// closest in the list above. Returns number of suggestions. */
+size_t hotkey_suggest (const struct hotkey* const want
+, struct hotkey* const out)
+{
+  UINT keys[HOTKEY_KEYS_MAX];
+  const size_t n = hotkey_keys (keys);
+  const int want_mod = hotkey_mod_index (want);
+  size_t want_key = n;
+  for (size_t i = 0; i != n; ++i) {
+    if (keys[i] == want->code) want_key = i;
+  }
+
+  size_t num = 0;
+  int score[HOTKEY_SUGGEST];
+  for (int m = 0; m != HOTKEY_MODS; ++m) {
+    for (size_t i = 0; i != n; ++i) {
+      if (hotkey_taken[m][keys[i]]) continue;
+      int s;
+      if (i == want_key) {
+        const int d = m ^ want_mod;
+        s = (d & 1) + ((d >> 1) & 1) + ((d >> 2) & 1) + ((d >> 3) & 1);
+      } else if (m == want_mod && want_key != n) {
+        s = 1 + abs ((int)i - (int)want_key);
+      } else continue;
+      if (s == 0) continue;
+
+      /* Keep the best few, sorted */
+      size_t j = num < HOTKEY_SUGGEST ? num++ : HOTKEY_SUGGEST;
+      while (j != 0 && score[j - 1] > s) {
+        if (j != HOTKEY_SUGGEST) {
+          score[j] = score[j - 1];
+          out[j] = out[j - 1];
+        }
+        --j;
+      }
+      if (j == HOTKEY_SUGGEST) continue;
+      score[j] = s;
+      objzero (&out[j]);
+      hotkey_mod_from_index (&out[j], m);
+      out[j].code = keys[i];
+    }
+  }
+  return num;
+}
+
+/* -----------------------------------------------------------------------------
+// Configuration file */
+
+const wchar_t* text_line (const wchar_t* s, wchar_t* const line, size_t const size)
+{
+  if (s == NULL || s[0] == '\0') return NULL;
+  const size_t len = wcscspn (s, L"\r\n");
+  const size_t num = len < size - 1 ? len : size - 1;
+  wcsncpy (line, s, num);
+  line[num] = '\0';
+  s += len;
+  if (s[0] == '\r') ++s;
+  if (s[0] == '\n') ++s;
+  return s;
+}
+
+/* Settings missing from the end of the file keep their values */
+void config_parse (const wchar_t* s)
+{
+#define read_line(line) do {\
+  if ((s = text_line (s, line, numof(line))) == NULL) return;\
+} while (0)
+  wchar_t line[BORDERLESS_COMPAT_LINE_MAX] = {0};
+  borderless_compat_clear();
+
+  /* Border hide hotkey */
+  read_line (line);
+  const wchar_t* l = line;
+  if (!parse_hotkey (&l, &hkey_border, hkey_border_def.id)
+  ) hkey_border = hkey_border_def;
+
+  /* Menu hide hotkey */
+  read_line (line);
+  l = line;
+  if (!parse_hotkey (&l, &hkey_menu, hkey_menu_def.id)
+  ) hkey_menu = hkey_menu_def;
+
+  /* Border style masks */
+  read_line (line);
+  style_mask = parse_mask (line);
+  read_line (line);
+  style_ex_mask = parse_mask (line);
+
+  /* Coffee button */
+  read_line (line);
+  show_coffee = _wcsicmp (line, L"true") == 0;
+
+  /* Border hide mode, optionally followed by `fullscreen` */
+  read_line (line);
+  wchar_t* const opt = wcschr (line, ' ');
+  if (opt != NULL) opt[0] = '\0';
+  auto_fullscreen = opt != NULL && _wcsicmp (opt + 1, L"fullscreen") == 0;
+  for (int m = 0; m != BORDER_MODE_COUNT; ++m) {
+    if (_wcsicmp (line, border_mode_str[m]) == 0) border_mode = m;
+  }
+
+  /* Per window class settings, one per line */
+  for (;;) {
+    read_line (line);
+    if (line[0] != '\0') borderless_compat_add (line);
+  }
+#undef read_line
+}
+
+bool config_read (const wchar_t* const path)
+{
+  wchar_t* const text = backend->file_read (path);
+  if (text == NULL) return false;
+  config_parse (text);
+  free (text);
+  return true;
+}
+
+void config_format (wchar_t* const text)
+{
+#define write_line(line) do {\
+  wcscat (text, line);\
+  wcscat (text, L"\n");\
+} while (0)
+  wchar_t line[BORDERLESS_COMPAT_LINE_MAX] = {0};
+  text[0] = '\0';
+
+  /* Border hide hotkey */
+  hotkey_to_str (line, &hkey_border, true);
+  write_line (line);
+
+  /* Menu hide hotkey */
+  hotkey_to_str (line, &hkey_menu, true);
+  write_line (line);
+
+  /* Border hide style masks */
+  _snwprintf (line, numof(line), L"0x%lx", (unsigned long)(DWORD)style_mask);
+  write_line (line);
+  _snwprintf (line, numof(line), L"0x%lx", (unsigned long)(DWORD)style_ex_mask);
+  write_line (line);
+
+  /* Coffee button */
+  wcscpy (line, show_coffee ? L"true" : L"false");
+  write_line (line);
+
+  /* Border hide mode */
+  wcscpy (line, border_mode_str[border_mode]);
+  if (auto_fullscreen) wcscat (line, L" fullscreen");
+  write_line (line);
+
+  /* Per window class settings */
+  for (size_t i = 0; borderless_compat_get (i, line, numof(line)); ++i) {
+    write_line (line);
+  }
+#undef write_line
+}
+
+bool config_write (const wchar_t* const path, const wchar_t* const text)
+{
+  /* Write a temporary file next to the config first:
+  // if anything goes wrong midway, the old one
+  // stays intact. */
+  wchar_t tmp[MAX_PATH];
+  _snwprintf (tmp, numof(tmp), L"%ls.tmp", path);
+  tmp[numof(tmp) - 1] = '\0';
+
+  /* Replace the old config in one step */
+  if (!backend->file_write (tmp, text) || !backend->file_replace (tmp, path)) {
+    backend->file_remove (tmp);
+    return false;
+  }
+  return true;
+}
+
+bool config_save (const wchar_t* const path)
+{
+  /* Too big for the stack of a thread started with the default size */
+  wchar_t* const text = arrnew (wchar_t, CONFIG_SIZE);
+  if (text == NULL) return false;
+  config_format (text);
+  const bool saved = config_write (path, text);
+  free (text);
+  return saved;
+}
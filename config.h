@@ -0,0 +1,120 @@
+/* =============================================================================
+// BORDERless: settings, hotkeys and the configuration file
+//
+// Private: a part of the app, not of the library. Hotkeys are registered
+// and files are read and written through the backend, see `backend.h`,
+// so none of this needs Windows to run.
+// -------------------------------------------------------------------------- */
+
+#ifndef BORDERLESS_CONFIG_H
+#define BORDERLESS_CONFIG_H
+
+#include "libborderless.h"
+
+/* -----------------------------------------------------------------------------
+// Hotkey */
+
+struct hotkey {
+  /* Currently set state */
+  union {
+    struct {
+      char ctrl, alt, shift, win;
+    };
+    int mod;
+  };
+  UINT code;
+  /* Last working state. If currently set state fails to register,
+  // this is restored. If last working state fails as well,
+  // the default combination is restored. If even that
+  // fails, the hotkey gets disabled. */
+  union {
+    struct {
+      char wctrl, walt, wshift, wwin;
+    };
+    int wmod;
+  };
+  UINT wcode;
+  /* Hotkey registration */
+  bool disabled;
+  bool clear; // used by UI
+  bool set; // `code` and `mod` are valid or not
+  bool reg; // registered
+  int id;
+};
+
+extern struct hotkey hkey_border;
+extern struct hotkey hkey_border_def;
+extern struct hotkey hkey_menu;
+extern struct hotkey hkey_menu_def;
+
+static inline void hotkey_save (struct hotkey* const hkey)
+{
+  hkey->wmod = hkey->mod;
+  hkey->wcode = hkey->code;
+}
+
+static inline void hotkey_restore (struct hotkey* const hkey)
+{
+  hkey->mod = hkey->wmod;
+  hkey->code = hkey->wcode;
+}
+
+static inline bool hotkey_is_set (const struct hotkey* const hkey)
+{
+  return (hkey->code >= 0x70 && hkey->code <= 0x87)
+  || (hkey->code != 0 && hkey->mod != 0);
+}
+
+static inline int hotkey_mod_to_int (const struct hotkey* const hkey)
+{
+  return (MOD_CONTROL * hkey->ctrl) | (MOD_ALT * hkey->alt)
+  | (MOD_SHIFT * hkey->shift) | (MOD_WIN * hkey->win)
+  | MOD_NOREPEAT;
+}
+
+bool hotkey_unregister (HWND wnd, struct hotkey* hkey);
+bool hotkey_register (HWND wnd, struct hotkey* hkey);
+/* `conf` for the configuration file, otherwise for the UI */
+void hotkey_to_str (wchar_t* str, const struct hotkey* hkey, bool conf);
+bool parse_hotkey (const wchar_t** str, struct hotkey* hkey, int id);
+
+/* Free hotkey discovery */
+#define HOTKEY_SUGGEST 3
+
+/* Registers and unregisters combinations near `want` on `wnd` */
+bool hotkey_scan (HWND wnd, const struct hotkey* want);
+/* Nearest free combinations found by the last scan for `want` */
+size_t hotkey_suggest (const struct hotkey* want, struct hotkey* out);
+
+/* -----------------------------------------------------------------------------
+// Settings */
+
+extern bool show_coffee;
+extern bool auto_fullscreen;
+extern LONG style_mask;
+extern LONG style_ex_mask;
+extern enum borderless_mode border_mode;
+
+/* Ways of hiding borders, as named in the config file */
+#define BORDER_MODE_COUNT 3
+extern const wchar_t* const border_mode_str[BORDER_MODE_COUNT];
+
+/* -----------------------------------------------------------------------------
+// Configuration file */
+
+#define CONFIG_SIZE (512 + BORDERLESS_COMPAT_MAX * BORDERLESS_COMPAT_LINE_MAX)
+
+/* Copies the line `s` starts with to `line`, cut to `size`,
+// without the line break. Returns the next line, NULL past the last. */
+const wchar_t* text_line (const wchar_t* s, wchar_t* line, size_t size);
+
+/* Settings and compatibility rules from the file contents */
+void config_parse (const wchar_t* text);
+bool config_read (const wchar_t* path);
+/* `text` must have room for `CONFIG_SIZE` characters */
+void config_format (wchar_t* text);
+/* Replaces the file in one step: either all of `text` makes it, or nothing */
+bool config_write (const wchar_t* path, const wchar_t* text);
+bool config_save (const wchar_t* path);
+
+#endif
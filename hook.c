@@ -0,0 +1,102 @@
+/* =============================================================================
+// BORDERless hook module
+//
+// Optionally loaded into selected target processes. Keeps masked frame
+// styles from coming back by filtering `WM_STYLECHANGING` right in the
+// window procedure of the target, so the user never sees the border
+// flicker and the window doesn't relayout twice.
+//
+// https://buymeacoff.ee/ubihazard
+// -------------------------------------------------------------------------- */
+
+#ifndef UNICODE
+/* Enable Unicode in WinAPI */
+#define UNICODE
+#endif
+
+#ifndef _WIN32_WINNT
+/* Enable Windows 7 features */
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <windows.h>
+#include <commctrl.h>
+#include <stdbool.h>
+
+#include "hook.h"
+
+#define HOOK_SUBCLASS_ID 0x424c
+
+static HANDLE mapping;
+static struct hook_table* table;
+
+static struct hook_entry* hook_find (HWND const wnd)
+{
+  return table != NULL ? hook_table_find (table, wnd) : NULL;
+}
+
+static LRESULT CALLBACK subclass_proc (HWND const wnd, UINT const msg
+, WPARAM const wparam, LPARAM const lparam, UINT_PTR const id, DWORD_PTR const ref)
+{
+  switch (msg) {
+  case WM_STYLECHANGING: {
+    struct hook_entry* const e = hook_find (wnd);
+    if (e == NULL) {
+      /* Border is being restored: step aside */
+      RemoveWindowSubclass (wnd, &subclass_proc, id);
+      break;
+    }
+    STYLESTRUCT* const ss = (STYLESTRUCT*)lparam;
+    const LONG mask = (int)wparam == GWL_STYLE ? e->mask
+    : (int)wparam == GWL_EXSTYLE ? e->mask_ex : 0;
+    if (ss->styleNew & mask) {
+      ss->styleNew &= ~mask;
+      InterlockedIncrement (&e->vetoed);
+    }
+    break;
+  }
+  case WM_NCDESTROY:
+    RemoveWindowSubclass (wnd, &subclass_proc, id);
+    break;
+  }
+  return DefSubclassProc (wnd, msg, wparam, lparam);
+}
+
+/* Installed for the thread of the target window only. Subclasses
+// the window the first time a message is sent to it. */
+__declspec(dllexport) LRESULT CALLBACK hook_proc (int const code
+, WPARAM const wparam, LPARAM const lparam)
+{
+  if (code == HC_ACTION) {
+    const CWPSTRUCT* const cwp = (const CWPSTRUCT*)lparam;
+    DWORD_PTR ref;
+    if (hook_find (cwp->hwnd) != NULL
+    && !GetWindowSubclass (cwp->hwnd, &subclass_proc, HOOK_SUBCLASS_ID, &ref)
+    &&  SetWindowSubclass (cwp->hwnd, &subclass_proc, HOOK_SUBCLASS_ID, 0)) {
+      /* Unhooking unloads the module, but the subclass
+      // may still be called: stay for good */
+      HMODULE self;
+      GetModuleHandleExW (GET_MODULE_HANDLE_EX_FLAG_PIN
+      | GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, (LPCWSTR)&subclass_proc, &self);
+    }
+  }
+  return CallNextHookEx (NULL, code, wparam, lparam);
+}
+
+BOOL WINAPI DllMain (HINSTANCE const inst, DWORD const reason, LPVOID const reserved)
+{
+  switch (reason) {
+  case DLL_PROCESS_ATTACH:
+    DisableThreadLibraryCalls (inst);
+    mapping = OpenFileMappingW (FILE_MAP_READ | FILE_MAP_WRITE, FALSE, HOOK_TABLE_NAME);
+    if (mapping != NULL) {
+      table = MapViewOfFile (mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(*table));
+    }
+    break;
+  case DLL_PROCESS_DETACH:
+    if (table != NULL) UnmapViewOfFile (table);
+    if (mapping != NULL) CloseHandle (mapping);
+    break;
+  }
+  return TRUE;
+}
@@ -0,0 +1,44 @@
+/* =============================================================================
+// BORDERless hook module: state shared with the target processes
+//
+// BORDERless fills a small table in named shared memory with the windows
+// whose frame must stay hidden. The hook module reads it right from
+// within the target process, so no messages go back and forth.
+// -------------------------------------------------------------------------- */
+
+#ifndef BORDERLESS_HOOK_H
+#define BORDERLESS_HOOK_H
+
+#define HOOK_TABLE_NAME L"Local\\BORDERless-hook-1710edcb-f650-41c4-9bbb-e1741e68aadd"
+#define HOOK_PROC_NAME "hook_proc"
+#define HOOK_MAX 64
+
+struct hook_entry {
+  /* Window handle, widened so that both bitnesses agree.
+  // Written last when an entry is added and cleared
+  // first when it is removed. Zero if unused. */
+  LONG64 volatile wnd;
+  LONG mask;
+  LONG mask_ex;
+  /* How many times the frame was kept from coming back */
+  LONG volatile vetoed;
+};
+
+struct hook_table {
+  LONG volatile used; // entries past this one are all unused
+  struct hook_entry entries[HOOK_MAX];
+};
+
+/* Entry of the window, NULL if none. Runs in the target for every
+// message sent to a thread with a hooked window, see `hook_proc()`. */
+static inline struct hook_entry* hook_table_find (struct hook_table* const table
+, HWND const wnd)
+{
+  const LONG used = table->used < HOOK_MAX ? table->used : HOOK_MAX;
+  for (LONG i = 0; i < used; ++i) {
+    if (table->entries[i].wnd == (LONG64)(ULONG_PTR)wnd) return table->entries + i;
+  }
+  return NULL;
+}
+
+#endif
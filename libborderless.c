@@ -0,0 +1,1641 @@
+/* =============================================================================
+// BORDERless library
+//
+// Everything it takes to hide and restore window borders and menus,
+// keep track of such windows and keep them that way. No tray icon,
+// no configuration window and no hotkeys: those belong to the app,
+// see `borderless.c`. The API is described in `libborderless.h`.
+//
+// Nothing in here talks to the window system directly: that is what
+// the backend is for, see `backend.h`.
+// -------------------------------------------------------------------------- */
+
+#ifndef UNICODE
+/* Enable Unicode in WinAPI */
+#define UNICODE
+#endif
+
+#ifndef _UNICODE
+/* Enable Unicode in C runtime */
+#define _UNICODE
+#endif
+
+#ifndef _WIN32_WINNT
+/* Enable Windows 7 features */
+#define _WIN32_WINNT 0x0601
+#endif
+
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <wchar.h>
+
+#include "libborderless.h"
+#include "backend.h"
+#include "common.h"
+
+/* -----------------------------------------------------------------------------
+// Library variables */
+
+/* Default masks for WinAPI window styles */
+#define STYLE_MASK (WS_CAPTION | WS_MAXIMIZEBOX | WS_MINIMIZEBOX | WS_SYSMENU | WS_THICKFRAME)
+#define STYLE_EX_MASK (WS_EX_CLIENTEDGE | WS_EX_STATICEDGE | WS_EX_WINDOWEDGE | WS_EX_DLGMODALFRAME)
+
+static LONG style_mask = STYLE_MASK;
+static LONG style_ex_mask = STYLE_EX_MASK;
+
+/* Between `borderless_init()` and `borderless_shutdown()` */
+static bool running;
+
+/* -----------------------------------------------------------------------------
+// Backend */
+
+#ifdef _WIN32
+const struct backend* backend = &backend_win32;
+#else
+const struct backend* backend;
+#endif
+
+/* Window handles get recycled: a record made for a window
+// is only valid while it is owned by the same thread */
+static inline bool window_alive (HWND const wnd, DWORD const thread)
+{
+  return thread != 0 && backend->get_thread (wnd) == thread;
+}
+
+/* -----------------------------------------------------------------------------
+// Thread confinement
+
+// Tracked window state (`border_store`, `menu_store`) and the style
+// masks are only ever touched on the thread which called
+// `borderless_init()`, checked by `assert_ui_thread()`. Timers and
+// window events are all delivered to it by the backend, and API calls
+// must come from it too. So there are no locks to wait on, neither
+// for the caller nor for anything reading the state. */
+static DWORD ui_thread;
+
+#define assert_ui_thread() assert (backend->current_thread() == ui_thread)
+
+/* -----------------------------------------------------------------------------
+// Window inventory
+
+// Top-level windows with a bit of cached metadata. Built once by
+// enumeration and then kept current from window events, so that
+// questions like "is it a top-level window" or "which windows
+// belong to this process" don't have to query every window
+// on the desktop. Sorted by handle, with two indices next to it:
+// by process and class, and by class alone. */
+
+struct window_info {
+  HWND wnd;
+  DWORD pid;
+  DWORD cls_hash;
+  DWORD title_hash;
+  bool visible;
+  wchar_t* exe; // full path, resolved on demand
+};
+
+static size_t inventory_size;
+static size_t inventory_cap;
+static struct window_info* inventory;
+static bool inventory_watching;
+
+/* Index entry, ordered by keys, then handle. With keys being process
+// and class hash, windows of a process are one run, and windows of a
+// class within it a shorter one; with class hash and zero, windows
+// of a class. Both indices have `inventory_size` entries. */
+struct inventory_key {
+  DWORD key;
+  DWORD key2;
+  HWND wnd;
+};
+
+static size_t inventory_index_cap;
+static struct inventory_key* inventory_by_pid;
+static struct inventory_key* inventory_by_cls;
+
+/* Called when a top-level window appears on screen */
+static borderless_window_fn* on_window;
+static void* on_window_param;
+
+/* FNV-1a. Class names are case-insensitive. */
+static DWORD hash_str (const wchar_t* s, bool const nocase)
+{
+  DWORD h = 2166136261u;
+  for (; s[0] != '\0'; ++s) {
+    const wchar_t c = nocase && s[0] >= 'A' && s[0] <= 'Z' ? s[0] | 0x20 : s[0];
+    h = (h ^ c) * 16777619u;
+  }
+  return h;
+}
+
+static DWORD window_cls_hash (HWND const wnd)
+{
+  wchar_t cls[256];
+  if (backend->get_class (wnd, cls, numof(cls)) == 0) return 0;
+  return hash_str (cls, true);
+}
+
+static DWORD window_title_hash (HWND const wnd)
+{
+  wchar_t title[256];
+  title[0] = '\0';
+  backend->get_title (wnd, title, numof(title));
+  return hash_str (title, false);
+}
+
+static size_t inventory_search (HWND const wnd)
+{
+  size_t lo = 0, hi = inventory_size;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if ((ULONG_PTR)inventory[mid].wnd < (ULONG_PTR)wnd) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+static struct window_info* inventory_find (HWND const wnd)
+{
+  const size_t i = inventory_search (wnd);
+  if (i != inventory_size && inventory[i].wnd == wnd) return inventory + i;
+  return NULL;
+}
+
+static inline bool key_less (const struct inventory_key* const a
+, const struct inventory_key* const b)
+{
+  if (a->key != b->key) return a->key < b->key;
+  if (a->key2 != b->key2) return a->key2 < b->key2;
+  return (ULONG_PTR)a->wnd < (ULONG_PTR)b->wnd;
+}
+
+/* First entry not less than `k` */
+static size_t index_search (const struct inventory_key* const index
+, size_t const size, const struct inventory_key* const k)
+{
+  size_t lo = 0, hi = size;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (key_less (index + mid, k)) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+/* `size` is before the change */
+static void index_update (struct inventory_key* const index, size_t const size
+, const struct inventory_key* const k, bool const add)
+{
+  const size_t i = index_search (index, size, k);
+  if (add) {
+    arrmove (index + i + 1, index + i, size - i);
+    index[i] = k[0];
+  } else if (i != size && index[i].wnd == k->wnd) {
+    arrmove (index + i, index + i + 1, size - i - 1);
+  }
+}
+
+static inline struct inventory_key key_pid (const struct window_info* const w)
+{
+  return (struct inventory_key){w->pid, w->cls_hash, w->wnd};
+}
+
+static inline struct inventory_key key_cls (const struct window_info* const w)
+{
+  return (struct inventory_key){w->cls_hash, 0, w->wnd};
+}
+
+/* Both indices have `size` entries before the change */
+static void inventory_index (const struct window_info* const w, size_t const size
+, bool const add)
+{
+  const struct inventory_key by_pid = key_pid (w);
+  const struct inventory_key by_cls = key_cls (w);
+  index_update (inventory_by_pid, size, &by_pid, add);
+  index_update (inventory_by_cls, size, &by_cls, add);
+}
+
+/* Room for one more entry in both indices */
+static bool inventory_index_reserve (void)
+{
+  if (inventory_size < inventory_index_cap) return true;
+  const size_t cap = inventory_index_cap != 0 ? inventory_index_cap * 2 : 8;
+  struct inventory_key* const by_pid = arrnewsize (inventory_by_pid, cap);
+  if (by_pid == NULL) return false;
+  inventory_by_pid = by_pid;
+  struct inventory_key* const by_cls = arrnewsize (inventory_by_cls, cap);
+  if (by_cls == NULL) return false;
+  inventory_by_cls = by_cls;
+  inventory_index_cap = cap;
+  return true;
+}
+
+static void inventory_refresh (struct window_info* const w)
+{
+  free (w->exe);
+  w->exe = NULL;
+  w->pid = backend->get_process (w->wnd);
+  w->cls_hash = window_cls_hash (w->wnd);
+  w->title_hash = window_title_hash (w->wnd);
+  w->visible = backend->is_visible (w->wnd);
+}
+
+static struct window_info* inventory_add (HWND const wnd)
+{
+  const size_t i = inventory_search (wnd);
+  struct window_info* w = inventory + i;
+  if (i == inventory_size || w->wnd != wnd) {
+    if (!inventory_index_reserve()) return NULL;
+    if (!arrreserve (inventory, inventory_size, inventory_cap)) return NULL;
+    w = inventory + i;
+    arrmove (w + 1, w, inventory_size - i);
+    objzero (w);
+    w->wnd = wnd;
+  } else {
+    /* Also refreshes recycled handles, which may move in the indices */
+    inventory_index (w, inventory_size, false);
+    --inventory_size;
+  }
+  inventory_refresh (w);
+  inventory_index (w, inventory_size, true);
+  ++inventory_size;
+  return w;
+}
+
+static void inventory_remove (HWND const wnd)
+{
+  struct window_info* const w = inventory_find (wnd);
+  if (w == NULL) return;
+  inventory_index (w, inventory_size, false);
+  free (w->exe);
+  arrmove (w, w + 1, inventory_size - (w + 1 - inventory));
+  --inventory_size;
+}
+
+static const wchar_t* inventory_exe (struct window_info* const w)
+{
+  if (w->exe != NULL) return w->exe;
+  wchar_t path[MAX_PATH];
+  if (backend->get_exe (w->pid, path, numof(path))) w->exe = _wcsdup (path);
+  return w->exe;
+}
+
+static void inventory_event (enum core_event const event, HWND const wnd)
+{
+  /* Destroyed windows can't be asked anything */
+  if (event == CORE_EVENT_DESTROY) {
+    inventory_remove (wnd);
+    return;
+  }
+
+  struct window_info* w = inventory_find (wnd);
+  const bool visible = w != NULL && w->visible;
+  if (w == NULL || event == CORE_EVENT_CREATE) {
+    if (backend->is_top_level (wnd)) w = inventory_add (wnd);
+  } else switch (event) {
+  case CORE_EVENT_SHOW: w->visible = true; break;
+  case CORE_EVENT_HIDE: w->visible = false; break;
+  case CORE_EVENT_NAMECHANGE: w->title_hash = window_title_hash (wnd); break;
+  default: break;
+  }
+  /* The callback may change the inventory: `w` is done with */
+  if (w != NULL && w->visible && !visible && on_window != NULL) {
+    on_window (wnd, w->pid, on_window_param);
+  }
+}
+
+static bool inventory_enum (HWND const wnd, void* const param)
+{
+  inventory_add (wnd);
+  return true;
+}
+
+static bool inventory_start (void)
+{
+  perf_begin (t);
+  /* Watch first so nothing created meanwhile is missed */
+  inventory_watching = backend->watch (CORE_WATCH_WINDOWS, true);
+  if (!inventory_watching) return false;
+  backend->enum_windows (&inventory_enum, NULL);
+  perf_log (t, L"inventory of %zu windows built", inventory_size);
+  return true;
+}
+
+static void inventory_stop (void)
+{
+  if (inventory_watching) backend->watch (CORE_WATCH_WINDOWS, false);
+  inventory_watching = false;
+  for (size_t i = 0; i != inventory_size; ++i) free (inventory[i].exe);
+  free (inventory);
+  inventory = NULL;
+  inventory_size = inventory_cap = 0;
+  free (inventory_by_pid);
+  free (inventory_by_cls);
+  inventory_by_pid = inventory_by_cls = NULL;
+  inventory_index_cap = 0;
+}
+
+static inline bool inventory_running (void)
+{
+  return inventory_watching;
+}
+
+/* Compare against a fresh enumeration */
+struct inventory_check_state {
+  size_t seen;
+  size_t bad;
+};
+
+static bool inventory_check_enum (HWND const wnd, void* const param)
+{
+  struct inventory_check_state* const st = param;
+  const struct window_info* const w = inventory_find (wnd);
+  ++st->seen;
+  if (w == NULL || w->pid != backend->get_process (wnd)
+  ||  w->cls_hash != window_cls_hash (wnd)
+  ||  w->visible != backend->is_visible (wnd)) {
+    wprintf (L"inventory: window %p is missing or out of date\n", (void*)wnd);
+    ++st->bad;
+  }
+  return true;
+}
+
+bool core_inventory_check (void)
+{
+  if (!inventory_running()) return true;
+  perf_begin (t);
+  struct inventory_check_state st = {0};
+  backend->enum_windows (&inventory_check_enum, &st);
+  if (st.seen != inventory_size) {
+    wprintf (L"inventory: %zu windows cached, %zu enumerated\n", inventory_size, st.seen);
+  }
+  /* Every window where the indices say it is */
+  for (size_t i = 0; i != inventory_size; ++i) {
+    const struct inventory_key by_pid = key_pid (inventory + i);
+    const struct inventory_key by_cls = key_cls (inventory + i);
+    const size_t p = index_search (inventory_by_pid, inventory_size, &by_pid);
+    const size_t c = index_search (inventory_by_cls, inventory_size, &by_cls);
+    if (p == inventory_size || memcmp (inventory_by_pid + p, &by_pid, sizeof(by_pid)) != 0
+    ||  c == inventory_size || memcmp (inventory_by_cls + c, &by_cls, sizeof(by_cls)) != 0) {
+      wprintf (L"inventory: window %p is not indexed\n", (void*)inventory[i].wnd);
+      ++st.bad;
+    }
+  }
+  perf_log (t, L"inventory checked: %zu of %zu windows wrong", st.bad, st.seen);
+  return st.bad == 0 && st.seen == inventory_size;
+}
+
+/* -----------------------------------------------------------------------------
+// Hide menu */
+
+struct top_level_test {
+  const HWND wnd;
+  bool is_top_level;
+};
+
+static bool enum_top_level (HWND const wnd, void* const param)
+{
+  struct top_level_test* const test = param;
+  if (test->wnd == wnd) {
+    test->is_top_level = true;
+    return false;
+  }
+  return true;
+}
+
+struct menu_store_item {
+  HWND wnd;
+  DWORD thread;
+  HMENU menu;
+};
+
+static size_t menu_store_size;
+static size_t menu_store_cap;
+static struct menu_store_item* menu_store;
+
+static void menu_store_erase (struct menu_store_item* const r)
+{
+  assert_ui_thread();
+  arrmove (r, r + 1, (menu_store_size - (r + 1 - menu_store)));
+  if (--menu_store_size == 0) {
+    free (menu_store);
+    menu_store = NULL;
+    menu_store_cap = 0;
+  }
+}
+
+static void menu_store_prune (void)
+{
+  size_t i = 0;
+  while (i != menu_store_size) {
+    struct menu_store_item* const r = menu_store + i;
+    if (!window_alive (r->wnd, r->thread)) menu_store_erase (r);
+    else ++i;
+  }
+}
+
+static struct menu_store_item* menu_find (HWND const wnd)
+{
+  const DWORD thread = backend->get_thread (wnd);
+  for (size_t i = 0; i != menu_store_size; ++i) {
+    struct menu_store_item* const r = menu_store + i;
+    if (r->wnd != wnd) continue;
+    /* Stale record of a dead window with the same handle */
+    if (r->thread == thread) return r;
+    menu_store_erase (r);
+    break;
+  }
+  return NULL;
+}
+
+static bool menu_set (const HWND wnd, enum borderless_action const action)
+{
+  assert_ui_thread();
+  if (action == BORDERLESS_KEEP) return false;
+
+  /* Find out if the window is a top-level window first */
+  if (inventory_running()) {
+    if (inventory_find (wnd) == NULL) return false;
+  } else {
+    struct top_level_test test = {.wnd = wnd};
+    backend->enum_windows (&enum_top_level, &test);
+    if (!test.is_top_level) return false;
+  }
+
+  /* See if menu is to be hidden or restored */
+  struct menu_store_item* const r = menu_find (wnd);
+  const bool hide = action == BORDERLESS_HIDE || (action == BORDERLESS_TOGGLE && r == NULL);
+  if (hide == (r != NULL)) return false;
+
+  if (hide) {
+    HMENU const menu = backend->get_menu (wnd);
+    if (menu == NULL) return false;
+    if (menu_store_size == menu_store_cap) menu_store_prune();
+    if (!arrreserve (menu_store, menu_store_size, menu_store_cap)) return false;
+    menu_store[menu_store_size++] = (struct menu_store_item){
+      .wnd = wnd,
+      .thread = backend->get_thread (wnd),
+      .menu = menu
+    };
+    backend->set_menu (wnd, NULL);
+  } else {
+    backend->set_menu (wnd, r->menu);
+    menu_store_erase (r);
+  }
+
+  return true;
+}
+
+/* -----------------------------------------------------------------------------
+// Compatibility database
+
+// One pair of style masks doesn't fit every window. Known window
+// classes get their own masks, the way to repaint after the change,
+// and whether their menu should go away together with the border.
+// User entries take precedence. */
+
+enum repaint {
+  REPAINT_MOVE,  // nudge the window size, see `backend->repaint()`
+  REPAINT_FRAME, // only ask to recompute the frame
+  REPAINT_NONE,
+  REPAINT_COUNT
+};
+
+static const wchar_t* const repaint_str[REPAINT_COUNT] = {
+  [REPAINT_MOVE]  = L"move",
+  [REPAINT_FRAME] = L"frame",
+  [REPAINT_NONE]  = L"none"
+};
+
+struct compat {
+  const wchar_t* cls; // window class name, or its prefix if ends with `*`
+  LONG mask;
+  LONG mask_ex;
+  enum repaint repaint;
+  bool menu; // hide the menu too
+  bool veto; // keep the frame from coming back, see `hook.c`
+};
+
+/* Masks for fullscreen multimedia windows and for regular ones */
+#define COMPAT_FULL 0xcf0000, 0x20301
+#define COMPAT_REGULAR 0xcb0000, 0x20300
+
+static const struct compat compat_builtin[] = {
+  /* Games and multimedia */
+  {L"SDL_app",             COMPAT_FULL,    REPAINT_MOVE,  false}, // SDL 2 & 3
+  {L"UnityWndClass",       COMPAT_FULL,    REPAINT_FRAME, false}, // Unity player
+  {L"GLFW30",              COMPAT_FULL,    REPAINT_MOVE,  false}, // GLFW 3
+  {L"Direct3DWindowClass", COMPAT_FULL,    REPAINT_MOVE,  true},  // DirectX SDK DXUT samples
+  {L"D3D Window",          COMPAT_FULL,    REPAINT_MOVE,  true},  // DirectX SDK D3DFrame samples
+  /* Regular applications */
+  {L"Chrome_WidgetWin_1",  COMPAT_REGULAR, REPAINT_FRAME, false}, // Chromium, Electron
+  {L"MozillaWindowClass",  COMPAT_REGULAR, REPAINT_FRAME, false}, // Firefox, Thunderbird
+  {L"Afx:*",               COMPAT_REGULAR, REPAINT_MOVE,  false}  // legacy MFC
+};
+
+#define COMPAT_USER_MAX BORDERLESS_COMPAT_MAX
+#define COMPAT_CLS_MAX 256
+#define COMPAT_LINE_MAX BORDERLESS_COMPAT_LINE_MAX
+
+static struct compat compat_user[COMPAT_USER_MAX];
+static wchar_t compat_user_cls[COMPAT_USER_MAX][COMPAT_CLS_MAX];
+static size_t compat_user_size;
+
+/* Returns settings for the window, falling back on global ones */
+static struct compat compat_lookup (HWND const wnd)
+{
+  wchar_t cls[COMPAT_CLS_MAX];
+  if (backend->get_class (wnd, cls, numof(cls)) != 0) {
+    for (size_t i = 0; i != compat_user_size; ++i) {
+      if (pattern_match (compat_user[i].cls, cls)) return compat_user[i];
+    }
+    for (size_t i = 0; i != numof(compat_builtin); ++i) {
+      if (pattern_match (compat_builtin[i].cls, cls)) return compat_builtin[i];
+    }
+  }
+  return (struct compat){
+    .mask = style_mask,
+    .mask_ex = style_ex_mask,
+    .repaint = REPAINT_MOVE
+  };
+}
+
+bool core_compat_match (HWND const wnd)
+{
+  return compat_lookup (wnd).cls != NULL;
+}
+
+/* Configuration file line: `<class> <mask> <ex mask> [<repaint>] [menu] [veto]` */
+static bool compat_parse (const wchar_t* s)
+{
+  if (compat_user_size == COMPAT_USER_MAX) return false;
+  struct compat* const c = compat_user + compat_user_size;
+  wchar_t* const cls = compat_user_cls[compat_user_size];
+  objzero (c);
+
+  size_t len = wcscspn (s, L" \t");
+  if (len == 0 || len >= COMPAT_CLS_MAX) return false;
+  wcsncpy (cls, s, len);
+  cls[len] = '\0';
+  c->cls = cls;
+
+  wchar_t* end;
+  c->mask = wcstoul (s + len, &end, 16);
+  if (end == s + len) return false;
+  s = end;
+  c->mask_ex = wcstoul (s, &end, 16);
+  if (end == s) return false;
+  s = end;
+
+  while (s[0] != '\0') {
+    s += wcsspn (s, L" \t");
+    len = wcscspn (s, L" \t");
+    if (len == 0) break;
+    if (len == cstrlen (L"menu") && cstrniequ (s, L"menu")) c->menu = true;
+    if (len == cstrlen (L"veto") && cstrniequ (s, L"veto")) c->veto = true;
+    for (int m = 0; m != REPAINT_COUNT; ++m) {
+      if (len == wcslen (repaint_str[m]) && _wcsnicmp (s, repaint_str[m], len) == 0) c->repaint = m;
+    }
+    s += len;
+  }
+
+  ++compat_user_size;
+  return true;
+}
+
+static void compat_format (wchar_t* const line, const struct compat* const c)
+{
+  _snwprintf (line, COMPAT_LINE_MAX, L"%ls 0x%lx 0x%lx %ls%ls%ls", c->cls
+  , (unsigned long)(DWORD)c->mask, (unsigned long)(DWORD)c->mask_ex
+  , repaint_str[c->repaint], c->menu ? L" menu" : L"", c->veto ? L" veto" : L"");
+}
+
+/* -----------------------------------------------------------------------------
+// Hide borders */
+
+/* Ways of hiding borders */
+enum border_mode {
+  /* Strip frame styles with `style_mask` and `style_ex_mask`.
+  // Works everywhere, but makes the window recompute
+  // its non-client area and relayout. */
+  BORDER_MODE_MASK = BORDERLESS_MODE_MASK,
+  /* Ask DWM not to draw the thin border and rounded corners
+  // of Windows 11. Styles are left alone, so nothing
+  // gets relayouted or repainted by the window. */
+  BORDER_MODE_DWM = BORDERLESS_MODE_DWM,
+  /* Clip the window to its client area with a window region.
+  // Styles are left alone too, for applications whose
+  // client area math assumes a frame is present. */
+  BORDER_MODE_REGION = BORDERLESS_MODE_REGION,
+  BORDER_MODE_COUNT
+};
+
+#ifndef NDEBUG
+static const wchar_t* const border_mode_str[BORDER_MODE_COUNT] = {
+  [BORDER_MODE_MASK]   = L"mask",
+  [BORDER_MODE_DWM]    = L"dwm",
+  [BORDER_MODE_REGION] = L"region"
+};
+#endif
+
+static enum border_mode border_mode = BORDER_MODE_MASK;
+
+struct border_store_item {
+  HWND wnd;
+  DWORD thread;
+  LONG style;
+  LONG style_ex;
+  enum border_mode mode; // how the border was hidden
+  enum border_mode asked; // before any fallback to masks
+  /* Mask mode: what was removed and how to repaint */
+  LONG mask, mask_ex;
+  enum repaint repaint;
+  bool veto;
+  void* hook; // hook module, if it was asked for
+  bool automatic; // hidden because the window went fullscreen
+  bool menu_too;  // the menu was hidden along with it, see `compat`
+  /* Region mode: window size and DPI the region was built for,
+  // and the region the application had set itself */
+  int width, height;
+  UINT dpi;
+  void* region;
+};
+
+static size_t border_store_size;
+static size_t border_store_cap;
+static struct border_store_item* border_store;
+
+/* Region clipping. The region only depends on window size and DPI,
+// so moves are ignored. Location changes are watched while at least
+// one window is clipped, and checks are coalesced on a timer. */
+#define TIMER_REGION 2
+#define REGION_DELAY 30
+
+static size_t region_count;
+static bool region_pending;
+
+static bool region_set (struct border_store_item* const r)
+{
+  RECT wr;
+  if (!backend->clip_client (r->wnd)) return false;
+  if (!backend->get_rect (r->wnd, &wr)) return false;
+  r->width = wr.right - wr.left;
+  r->height = wr.bottom - wr.top;
+  r->dpi = backend->get_dpi (r->wnd);
+  return true;
+}
+
+static bool region_update (struct border_store_item* const r)
+{
+  RECT wr;
+  if (!backend->get_rect (r->wnd, &wr)) return false;
+  if (wr.right - wr.left == r->width && wr.bottom - wr.top == r->height
+  && backend->get_dpi (r->wnd) == r->dpi) return false;
+  return region_set (r);
+}
+
+static void region_location (HWND const wnd)
+{
+  if (region_pending) return;
+  for (size_t i = 0; i != border_store_size; ++i) {
+    if (border_store[i].wnd == wnd && border_store[i].mode == BORDER_MODE_REGION) {
+      region_pending = true;
+      backend->set_timer (TIMER_REGION, REGION_DELAY);
+      return;
+    }
+  }
+}
+
+/* Location changes are needed by clipped windows and by fullscreen
+// detection. There is only one watch for both, on while either
+// needs it. */
+static bool fullscreen_enabled; // see "Fullscreen windows" below
+static bool location_watching;
+
+static bool location_watch (void)
+{
+  const bool need = region_count != 0 || fullscreen_enabled;
+  if (need != location_watching
+  && backend->watch (CORE_WATCH_LOCATION, need)) location_watching = need;
+  return need == location_watching;
+}
+
+static void border_repaint (const struct border_store_item* const r)
+{
+  switch (r->repaint) {
+  case REPAINT_MOVE:  backend->repaint (r->wnd); break;
+  case REPAINT_FRAME: backend->frame_changed (r->wnd); break;
+  default: break;
+  }
+}
+
+/* Hook module. Some applications keep restoring their own frame.
+// Reacting to that after the fact means visible flicker and another
+// relayout, so for windows that opted in a small module is loaded
+// into the target process to filter style changes at the source. */
+static bool hook_attach (struct border_store_item* const r)
+{
+  r->hook = backend->veto_attach (r->wnd, r->thread, r->mask, r->mask_ex);
+  return r->hook != NULL;
+}
+
+static void hook_detach (struct border_store_item* const r)
+{
+  if (r->hook == NULL) return;
+  perf_begin (t);
+  const long vetoed = backend->veto_detach (r->hook);
+  perf_log (t, L"hook detached, frame restoration vetoed %ld times", vetoed);
+  (void)vetoed;
+  r->hook = NULL;
+}
+
+/* Without `repaint` the frame is left for the caller to recompute.
+// Returns whether it needs to be, which is in mask mode only. */
+static bool border_hide (struct border_store_item* const r, bool const repaint)
+{
+  /* Fall back to style masks where DWM can't help */
+  if (r->mode == BORDER_MODE_DWM) {
+    if (backend->dwm_border (r->wnd, true)) return false;
+    r->mode = BORDER_MODE_MASK;
+  }
+  if (r->mode == BORDER_MODE_REGION) {
+    /* Shaped windows get their shape back on restore */
+    r->region = backend->get_region (r->wnd);
+    if (region_set (r)) {
+      ++region_count;
+      location_watch();
+      return false;
+    }
+    /* Undo whatever part of it went through */
+    backend->unclip (r->wnd, r->region);
+    r->region = NULL;
+    r->mode = BORDER_MODE_MASK;
+  }
+  if (r->veto) hook_attach (r);
+  backend->set_style (r->wnd, GWL_EXSTYLE, r->style_ex & ~r->mask_ex);
+  backend->set_style (r->wnd, GWL_STYLE, r->style & ~r->mask);
+  if (repaint) border_repaint (r);
+  return true;
+}
+
+static bool border_restore (struct border_store_item* const r, bool const repaint)
+{
+  hook_detach (r);
+  switch (r->mode) {
+  case BORDER_MODE_DWM:
+    backend->dwm_border (r->wnd, false);
+    return false;
+  case BORDER_MODE_REGION:
+    backend->unclip (r->wnd, r->region);
+    r->region = NULL;
+    return false;
+  default:
+    backend->set_style (r->wnd, GWL_STYLE, r->style);
+    backend->set_style (r->wnd, GWL_EXSTYLE, r->style_ex);
+    if (repaint) border_repaint (r);
+    return true;
+  }
+}
+
+static void border_store_erase (struct border_store_item* const r)
+{
+  assert_ui_thread();
+  hook_detach (r);
+  if (r->mode == BORDER_MODE_REGION) {
+    if (r->region != NULL) backend->free_region (r->region);
+    --region_count;
+    location_watch();
+  }
+  arrmove (r, r + 1, (border_store_size - (r + 1 - border_store)));
+  /* Give memory back once nothing is tracked */
+  if (--border_store_size == 0) {
+    free (border_store);
+    border_store = NULL;
+    border_store_cap = 0;
+  }
+}
+
+/* Drop records of windows which are gone */
+static void border_store_prune (void)
+{
+  size_t i = 0;
+  while (i != border_store_size) {
+    struct border_store_item* const r = border_store + i;
+    if (!window_alive (r->wnd, r->thread)) border_store_erase (r);
+    else ++i;
+  }
+}
+
+static void region_update_all (void)
+{
+  perf_begin (t);
+  size_t updated = 0;
+  region_pending = false;
+  size_t i = 0;
+  while (i != border_store_size) {
+    struct border_store_item* const r = border_store + i;
+    if (r->mode != BORDER_MODE_REGION) {
+      ++i;
+      continue;
+    }
+    /* The handle may belong to some other window by now */
+    if (!window_alive (r->wnd, r->thread)) {
+      border_store_erase (r);
+      continue;
+    }
+    updated += region_update (r);
+    ++i;
+  }
+  if (updated != 0) perf_log (t, L"updated %zu window regions", updated);
+}
+
+static struct border_store_item* border_find (HWND const wnd)
+{
+  const DWORD thread = backend->get_thread (wnd);
+  for (size_t i = 0; i != border_store_size; ++i) {
+    struct border_store_item* const r = border_store + i;
+    if (r->wnd != wnd) continue;
+    /* Stale record of a dead window with the same handle */
+    if (r->thread == thread) return r;
+    border_store_erase (r);
+    break;
+  }
+  return NULL;
+}
+
+/* Records the window with its current styles. Masks and mode
+// come from `op` where it has them, otherwise from `c`. */
+static struct border_store_item* border_add (HWND const wnd
+, const struct compat* const c, const struct borderless_op* const op)
+{
+  const LONG style = backend->get_style (wnd, GWL_STYLE);
+  if (style == 0) return NULL;
+  const LONG style_ex = backend->get_style (wnd, GWL_EXSTYLE);
+  if (style_ex == 0) return NULL;
+
+  /* Before growing, see if there are dead windows to forget */
+  if (border_store_size == border_store_cap) border_store_prune();
+  if (!arrreserve (border_store, border_store_size, border_store_cap)) return NULL;
+  struct border_store_item* const r = border_store + border_store_size++;
+  const bool masks = op != NULL && (op->mask != 0 || op->mask_ex != 0);
+  const enum border_mode mode = op != NULL && op->mode >= 0 && op->mode < BORDER_MODE_COUNT
+  ? op->mode : border_mode;
+  *r = (struct border_store_item){
+    .wnd = wnd,
+    .thread = backend->get_thread (wnd),
+    .style = style,
+    .style_ex = style_ex,
+    .mode = mode,
+    .asked = mode,
+    .mask = masks ? op->mask : c->mask,
+    .mask_ex = masks ? op->mask_ex : c->mask_ex,
+    .repaint = c->repaint,
+    .veto = c->veto
+  };
+  return r;
+}
+
+/* Hides or restores the border. See `border_hide()` for `repaint`.
+// `frame` tells whether the frame is to be recomputed. */
+static bool border_set (HWND const wnd, enum borderless_action const action
+, const struct borderless_op* const op, bool const repaint, bool* const frame)
+{
+  assert_ui_thread();
+  if (action == BORDERLESS_KEEP) return false;
+
+  /* See if border is to be hidden or restored */
+  struct border_store_item* r = border_find (wnd);
+  const bool hide = action == BORDERLESS_HIDE || (action == BORDERLESS_TOGGLE && r == NULL);
+  if (hide == (r != NULL)) return false;
+
+  perf_begin (t);
+  bool changed;
+
+  if (hide) {
+    const struct compat c = compat_lookup (wnd);
+    r = border_add (wnd, &c, op);
+    if (r == NULL) return false;
+    changed = border_hide (r, repaint);
+    /* A menu hidden on its own stays hidden on restore */
+    if (c.menu && menu_find (wnd) == NULL) r->menu_too = menu_set (wnd, BORDERLESS_HIDE);
+    /* Setting the menu recomputed the frame with the new styles */
+    if (r->menu_too) changed = false;
+    perf_log (t, L"border hidden (%ls, %ls)", border_mode_str[r->mode]
+    , c.cls != NULL ? c.cls : L"default");
+  } else {
+    const bool menu_too = r->menu_too;
+    changed = border_restore (r, repaint);
+    perf_log (t, L"border restored (%ls)", border_mode_str[r->mode]);
+    border_store_erase (r);
+    if (menu_too && menu_set (wnd, BORDERLESS_RESTORE)) changed = false;
+  }
+
+  if (frame != NULL) frame[0] = changed;
+  return true;
+}
+
+/* Hidden already, but not the way `op` explicitly asks: undone
+// without repainting, so that `border_set()` hides it again and
+// the frame is recomputed once. Returns whether it was undone. */
+static bool border_refit (const struct borderless_op* const op, bool* const menu_too)
+{
+  if (op->border != BORDERLESS_HIDE) return false;
+  struct border_store_item* const r = border_find (op->wnd);
+  if (r == NULL) return false;
+  const bool mode = op->mode >= 0 && op->mode < BORDER_MODE_COUNT && op->mode != r->asked;
+  const bool masks = (op->mask != 0 || op->mask_ex != 0) && r->asked == BORDER_MODE_MASK
+  && (op->mask != r->mask || op->mask_ex != r->mask_ex);
+  if (!mode && !masks) return false;
+  menu_too[0] = r->menu_too;
+  border_restore (r, false);
+  border_store_erase (r);
+  return true;
+}
+
+/* Menu on request: from now on it is the caller's to restore,
+// not the border's */
+static bool menu_set_own (HWND const wnd, enum borderless_action const action)
+{
+  if (!menu_set (wnd, action)) return false;
+  struct border_store_item* const r = border_find (wnd);
+  if (r != NULL) r->menu_too = false;
+  return true;
+}
+
+/* -----------------------------------------------------------------------------
+// Window inventory queries */
+
+struct inventory_filter {
+  DWORD pid;          // 0 for any process
+  const wchar_t* cls; // NULL for any class
+  bool tracked;       // only windows with hidden border or menu
+};
+
+static bool is_tracked (HWND const wnd)
+{
+  for (size_t i = 0; i != border_store_size; ++i) {
+    if (border_store[i].wnd == wnd) return true;
+  }
+  for (size_t i = 0; i != menu_store_size; ++i) {
+    if (menu_store[i].wnd == wnd) return true;
+  }
+  return false;
+}
+
+/* Fills `out` with up to `max` matching windows.
+// Returns how many windows matched in total. */
+static size_t inventory_query (const struct inventory_filter* const f
+, HWND* const out, size_t const max)
+{
+  const DWORD cls_hash = f->cls != NULL ? hash_str (f->cls, true) : 0;
+  size_t num = 0;
+
+  /* Tracked state only: every window */
+  if (f->pid == 0 && f->cls == NULL) {
+    for (size_t i = 0; i != inventory_size; ++i) {
+      HWND const wnd = inventory[i].wnd;
+      if (f->tracked && !is_tracked (wnd)) continue;
+      if (num < max) out[num] = wnd;
+      ++num;
+    }
+    return num;
+  }
+
+  /* Otherwise a run of one of the indices */
+  const struct inventory_key* const index = f->pid != 0 ? inventory_by_pid : inventory_by_cls;
+  const struct inventory_key k = f->pid != 0
+  ? (struct inventory_key){f->pid, cls_hash, NULL}
+  : (struct inventory_key){cls_hash, 0, NULL};
+  for (size_t i = index_search (index, inventory_size, &k); i != inventory_size; ++i) {
+    if (index[i].key != k.key || (f->cls != NULL && index[i].key2 != k.key2)) break;
+    if (f->tracked && !is_tracked (index[i].wnd)) continue;
+    if (num < max) out[num] = index[i].wnd;
+    ++num;
+  }
+  return num;
+}
+
+/* -----------------------------------------------------------------------------
+// Re-apply after display changes */
+
+/* Resolution switches, monitor hot-plug and docking often make
+// applications rebuild their frames. Such events tend to come in
+// bursts, so the actual pass is deferred until things settle. */
+#define TIMER_REAPPLY 1
+#define REAPPLY_DELAY 500
+
+static void reapply_schedule (void)
+{
+  /* Re-arming the timer with the same id restarts the countdown */
+  backend->set_timer (TIMER_REAPPLY, REAPPLY_DELAY);
+}
+
+static void reapply_all (void)
+{
+  assert_ui_thread();
+  perf_begin (t);
+
+  /* Only touch windows which actually got their frame back */
+  size_t drifted = 0;
+  HWND* const wnds = arrnew (HWND, border_store_size + 1);
+  size_t i = 0;
+  while (i != border_store_size) {
+    /* Store shrinks as dead windows are dropped: index, not pointer */
+    struct border_store_item* const r = border_store + i;
+    if (!window_alive (r->wnd, r->thread)) {
+      border_store_erase (r);
+      continue;
+    }
+    /* DWM attributes survive frame rebuilds,
+    // regions only need to follow the new size */
+    if (r->mode != BORDER_MODE_MASK) {
+      if (r->mode == BORDER_MODE_REGION) region_update (r);
+      ++i;
+      continue;
+    }
+    const LONG style = backend->get_style (r->wnd, GWL_STYLE);
+    const LONG style_ex = backend->get_style (r->wnd, GWL_EXSTYLE);
+    if ((style & r->mask) || (style_ex & r->mask_ex)) {
+      backend->set_style (r->wnd, GWL_EXSTYLE, style_ex & ~r->mask_ex);
+      backend->set_style (r->wnd, GWL_STYLE, style & ~r->mask);
+      if (wnds != NULL) wnds[drifted] = r->wnd;
+      else backend->repaint (r->wnd);
+      ++drifted;
+    }
+    ++i;
+  }
+
+  /* Recompute all affected frames in one go */
+  if (wnds != NULL && drifted != 0) {
+    const RECT none = {0};
+    HDWP dwp = backend->defer_begin (drifted);
+    for (i = 0; i != drifted && dwp != NULL; ++i) {
+      dwp = backend->defer_pos (dwp, wnds[i], &none
+      , SWP_FRAMECHANGED | SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER
+      | SWP_NOOWNERZORDER | SWP_NOACTIVATE);
+    }
+    if (dwp == NULL || !backend->defer_end (dwp)) {
+      for (i = 0; i != drifted; ++i) backend->repaint (wnds[i]);
+    }
+  }
+  free (wnds);
+
+  /* Menus which were re-attached */
+  i = 0;
+  while (i != menu_store_size) {
+    struct menu_store_item* const m = menu_store + i;
+    if (!window_alive (m->wnd, m->thread)) {
+      menu_store_erase (m);
+      continue;
+    }
+    HMENU const menu = backend->get_menu (m->wnd);
+    if (menu != NULL) {
+      /* The application may have built a brand new menu */
+      m->menu = menu;
+      backend->set_menu (m->wnd, NULL);
+      ++drifted;
+    }
+    ++i;
+  }
+
+  perf_log (t, L"re-applied %zu windows, %zu records kept", drifted
+  , border_store_size + menu_store_size);
+}
+
+/* -----------------------------------------------------------------------------
+// Fullscreen windows */
+
+/* Optionally hide borders of windows as soon as they cover a whole
+// monitor and bring them back once they don't. Window moves are
+// watched rather than polled: each location change only queues the
+// window, and everything queued is checked in one go after a short
+// delay, so a burst of moves costs one check per window. Monitor
+// rectangles are cached and refreshed on display changes. */
+#define TIMER_FULLSCREEN 4
+#define FULLSCREEN_DELAY 100
+#define FULLSCREEN_TOLERANCE 2 // pixels a window may fall short of monitor edges
+
+static size_t fullscreen_pending_size;
+static size_t fullscreen_pending_cap;
+static HWND* fullscreen_pending;
+#ifndef NDEBUG
+static size_t fullscreen_events; // since the last check
+#endif
+
+/* Windows which had their borders restored by hand while fullscreen:
+// left alone until they leave fullscreen */
+struct fullscreen_declined_item {
+  HWND wnd;
+  DWORD thread;
+};
+
+static size_t fullscreen_declined_size;
+static size_t fullscreen_declined_cap;
+static struct fullscreen_declined_item* fullscreen_declined;
+
+static size_t monitor_size;
+static size_t monitor_cap;
+static RECT* monitor_rects;
+
+static void monitor_refresh (void)
+{
+  const size_t num = backend->get_monitors (NULL, 0);
+  if (num > monitor_cap) {
+    RECT* const rects = arrnewsize (monitor_rects, num);
+    if (rects != NULL) {
+      monitor_rects = rects;
+      monitor_cap = num;
+    }
+  }
+  monitor_size = backend->get_monitors (monitor_rects, monitor_cap);
+  if (monitor_size > monitor_cap) monitor_size = monitor_cap;
+}
+
+static bool covers_monitor (const RECT* const wr)
+{
+  for (size_t i = 0; i != monitor_size; ++i) {
+    const RECT* const m = monitor_rects + i;
+    if (wr->left <= m->left + FULLSCREEN_TOLERANCE
+    &&  wr->top <= m->top + FULLSCREEN_TOLERANCE
+    &&  wr->right >= m->right - FULLSCREEN_TOLERANCE
+    &&  wr->bottom >= m->bottom - FULLSCREEN_TOLERANCE) return true;
+  }
+  return false;
+}
+
+static void fullscreen_queue (HWND const wnd)
+{
+  for (size_t i = 0; i != fullscreen_pending_size; ++i) {
+    if (fullscreen_pending[i] == wnd) return;
+  }
+  if (!arrreserve (fullscreen_pending, fullscreen_pending_size, fullscreen_pending_cap)) return;
+  fullscreen_pending[fullscreen_pending_size++] = wnd;
+  /* Armed once per batch, not restarted on every move:
+  // windows being dragged around still get checked */
+  if (fullscreen_pending_size == 1) backend->set_timer (TIMER_FULLSCREEN, FULLSCREEN_DELAY);
+}
+
+static void fullscreen_location (HWND const wnd)
+{
+  /* Caret and cursor moves come through here too: keep it cheap */
+  if (inventory_running() ? inventory_find (wnd) == NULL : !backend->is_top_level (wnd)) return;
+#ifndef NDEBUG
+  ++fullscreen_events;
+#endif
+  fullscreen_queue (wnd);
+}
+
+static size_t fullscreen_declined_find (HWND const wnd)
+{
+  size_t i = 0;
+  while (i != fullscreen_declined_size && fullscreen_declined[i].wnd != wnd) ++i;
+  return i;
+}
+
+static void fullscreen_declined_erase (size_t const i)
+{
+  arrmove (fullscreen_declined + i, fullscreen_declined + i + 1
+  , fullscreen_declined_size - i - 1);
+  --fullscreen_declined_size;
+}
+
+/* Windows destroyed while declined would otherwise stay forever,
+// and their handles would decline for whatever window gets them */
+static void fullscreen_declined_prune (void)
+{
+  size_t i = 0;
+  while (i != fullscreen_declined_size) {
+    const struct fullscreen_declined_item* const d = fullscreen_declined + i;
+    if (!window_alive (d->wnd, d->thread)) fullscreen_declined_erase (i);
+    else ++i;
+  }
+}
+
+static void fullscreen_destroyed (HWND const wnd)
+{
+  const size_t d = fullscreen_declined_find (wnd);
+  if (d != fullscreen_declined_size) fullscreen_declined_erase (d);
+}
+
+static void fullscreen_check (HWND const wnd)
+{
+  struct border_store_item* r = NULL;
+  for (size_t i = 0; i != border_store_size; ++i) {
+    if (border_store[i].wnd == wnd) r = border_store + i;
+  }
+  /* Forget dead windows with the same handle */
+  if (r != NULL && !window_alive (r->wnd, r->thread)) {
+    border_store_erase (r);
+    r = NULL;
+  }
+  /* Dead ones are gone by now, see `fullscreen_check_all()` */
+  const size_t d = fullscreen_declined_find (wnd);
+
+  /* Borders hidden by hand are for the user to restore */
+  if (r != NULL && !r->automatic) return;
+  /* Fullscreen windows get minimized on Alt-Tab: nothing changes */
+  if (!backend->is_visible (wnd) || backend->is_minimized (wnd)) return;
+  RECT wr;
+  if (!backend->get_rect (wnd, &wr)) return;
+  /* Maximized windows are regular ones, even with the taskbar hidden */
+  const bool fullscreen = !backend->is_maximized (wnd) && covers_monitor (&wr);
+
+  if (d != fullscreen_declined_size) {
+    if (!fullscreen) fullscreen_declined_erase (d);
+    return;
+  }
+  if (r != NULL) {
+    if (!fullscreen) border_set (wnd, BORDERLESS_RESTORE, NULL, true, NULL);
+    return;
+  }
+  if (!fullscreen) return;
+
+  /* Only windows with some frame left to hide */
+  const struct compat c = compat_lookup (wnd);
+  if (!(backend->get_style (wnd, GWL_STYLE) & c.mask)
+  &&  !(backend->get_style (wnd, GWL_EXSTYLE) & c.mask_ex)) return;
+  /* New records go at the end of the store */
+  if (border_set (wnd, BORDERLESS_HIDE, NULL, true, NULL)) {
+    border_store[border_store_size - 1].automatic = true;
+  }
+}
+
+static void fullscreen_check_all (void)
+{
+  assert_ui_thread();
+  perf_begin (t);
+  /* Hiding borders moves windows, which queues them up again */
+  HWND* const wnds = fullscreen_pending;
+  const size_t num = fullscreen_pending_size;
+  fullscreen_pending = NULL;
+  fullscreen_pending_size = fullscreen_pending_cap = 0;
+  /* Destruction events take care of it while windows are watched */
+  if (!inventory_running()) fullscreen_declined_prune();
+  for (size_t i = 0; i != num; ++i) fullscreen_check (wnds[i]);
+  free (wnds);
+  perf_log (t, L"fullscreen: %zu windows checked, %zu moves coalesced"
+  , num, fullscreen_events);
+#ifndef NDEBUG
+  fullscreen_events = 0;
+#endif
+}
+
+static bool fullscreen_enum (HWND const wnd, void* const param)
+{
+  if (backend->is_visible (wnd)) fullscreen_queue (wnd);
+  return true;
+}
+
+static bool fullscreen_start (void)
+{
+  if (fullscreen_enabled) return true;
+  monitor_refresh();
+  fullscreen_enabled = true;
+  if (!location_watch()) {
+    fullscreen_enabled = false;
+    return false;
+  }
+  /* Windows which are fullscreen already won't move on their own */
+  backend->enum_windows (&fullscreen_enum, NULL);
+  return true;
+}
+
+/* Borders hidden so far stay hidden */
+static void fullscreen_stop (void)
+{
+  fullscreen_enabled = false;
+  location_watch();
+  backend->kill_timer (TIMER_FULLSCREEN);
+  free (fullscreen_pending);
+  fullscreen_pending = NULL;
+  fullscreen_pending_size = fullscreen_pending_cap = 0;
+  free (fullscreen_declined);
+  fullscreen_declined = NULL;
+  fullscreen_declined_size = fullscreen_declined_cap = 0;
+  free (monitor_rects);
+  monitor_rects = NULL;
+  monitor_size = monitor_cap = 0;
+}
+
+/* Borders restored by hand while fullscreen are left
+// alone until the window leaves fullscreen */
+static void fullscreen_decline (HWND const wnd)
+{
+  if (!fullscreen_enabled) return;
+  if (!arrreserve (fullscreen_declined, fullscreen_declined_size, fullscreen_declined_cap)) return;
+  fullscreen_declined[fullscreen_declined_size++] = (struct fullscreen_declined_item){
+    .wnd = wnd,
+    .thread = backend->get_thread (wnd)
+  };
+}
+
+/* -----------------------------------------------------------------------------
+// Batches */
+
+static void batch_place (HDWP* const dwp, const struct borderless_op* const op
+, bool const frame)
+{
+  const RECT* const rc = &op->rect;
+  UINT flags = SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOACTIVATE;
+  if (frame) flags |= SWP_FRAMECHANGED;
+  if (op->place == BORDERLESS_PLACE_RECT) {
+    /* Minimized and maximized windows can't be placed */
+    if (backend->is_minimized (op->wnd) || backend->is_maximized (op->wnd)) {
+      backend->show (op->wnd, SW_SHOWNOACTIVATE);
+    }
+  } else flags |= SWP_NOMOVE | SWP_NOSIZE;
+  if (dwp[0] != NULL) dwp[0] = backend->defer_pos (dwp[0], op->wnd, rc, flags);
+  /* Failed batch is gone: the rest is placed one by one */
+  if (dwp[0] == NULL) backend->set_pos (op->wnd, rc, flags);
+}
+
+static size_t batch_apply (const struct borderless_op* const ops, size_t const num)
+{
+  assert_ui_thread();
+  perf_begin (t);
+  size_t changed = 0;
+
+  /* Styles change right away, frames are recomputed all together */
+  HDWP dwp = backend->defer_begin (num);
+  for (size_t i = 0; i != num; ++i) {
+    const struct borderless_op* const op = ops + i;
+    bool menu_too = false;
+    const bool refit = border_refit (op, &menu_too);
+    bool frame = false;
+    bool done = border_set (op->wnd, op->border, op, false, &frame);
+    if (refit) {
+      /* Still the border's menu to restore */
+      struct border_store_item* const r = done ? border_store + border_store_size - 1 : NULL;
+      if (r != NULL) r->menu_too = menu_too;
+      else if (menu_too) menu_set (op->wnd, BORDERLESS_RESTORE);
+      frame = done = true;
+    }
+    if (menu_set_own (op->wnd, op->menu)) {
+      /* And recomputed the frame */
+      frame = false;
+      done = true;
+    }
+    if (frame || op->place != BORDERLESS_PLACE_NONE) batch_place (&dwp, op, frame);
+    changed += done || op->place != BORDERLESS_PLACE_NONE;
+  }
+  if (dwp != NULL) backend->defer_end (dwp);
+
+  /* Maximized last, restoring to `rect`, or to where it was without one */
+  for (size_t i = 0; i != num; ++i) {
+    if (ops[i].place != BORDERLESS_PLACE_MAXIMIZED) continue;
+    RECT rc = ops[i].rect;
+    bool maximized;
+    if (rc.right <= rc.left || rc.bottom <= rc.top) {
+      if (!backend->get_placement (ops[i].wnd, &rc, &maximized) || maximized) continue;
+    }
+    backend->set_placement (ops[i].wnd, &rc, true);
+  }
+
+  perf_log (t, L"batch of %zu: %zu windows changed", num, changed);
+  return changed;
+}
+
+static size_t batch_process (DWORD const pid, enum borderless_action const border
+, enum borderless_action const menu)
+{
+  if (pid == 0) return 0;
+  const struct inventory_filter f = {.pid = pid};
+  const size_t total = inventory_query (&f, NULL, 0);
+  HWND* const wnds = arrnew (HWND, total + 1);
+  struct borderless_op* const ops = arrnew (struct borderless_op, total + 1);
+  size_t changed = 0;
+  if (wnds != NULL && ops != NULL) {
+    inventory_query (&f, wnds, total);
+    size_t num = 0;
+    for (size_t i = 0; i != total; ++i) {
+      if (!backend->is_visible (wnds[i])) continue;
+      ops[num++] = (struct borderless_op){
+        .wnd = wnds[i],
+        .border = border,
+        .menu = menu,
+        .mode = -1
+      };
+    }
+    changed = batch_apply (ops, num);
+  }
+  free (wnds);
+  free (ops);
+  return changed;
+}
+
+/* -----------------------------------------------------------------------------
+// Backend events */
+
+void core_event (enum core_event const event, HWND const wnd)
+{
+  assert_ui_thread();
+  if (event != CORE_EVENT_LOCATION) {
+    if (inventory_running()) inventory_event (event, wnd);
+    if (event == CORE_EVENT_DESTROY && fullscreen_declined_size != 0) fullscreen_destroyed (wnd);
+    return;
+  }
+  if (region_count != 0) region_location (wnd);
+  if (fullscreen_enabled) fullscreen_location (wnd);
+}
+
+void core_timer (UINT const id)
+{
+  assert_ui_thread();
+  backend->kill_timer (id);
+  if      (id == TIMER_REAPPLY)    reapply_all();
+  else if (id == TIMER_REGION)     region_update_all();
+  else if (id == TIMER_FULLSCREEN) fullscreen_check_all();
+}
+
+/* Display topology or resolution changes */
+void core_display_changed (void)
+{
+  assert_ui_thread();
+  if (fullscreen_enabled) monitor_refresh();
+  reapply_schedule();
+}
+
+/* ========================================================================== */
+
+BORDERLESS_API bool borderless_set_backend (const struct backend* const impl)
+{
+  if (running) return false;
+  backend = impl;
+  return true;
+}
+
+BORDERLESS_API bool borderless_init (const struct borderless_config* const config)
+{
+  if (running || backend == NULL) return false;
+  if (config != NULL && config->size < sizeof(*config)) return false;
+  ui_thread = backend->current_thread();
+  if (!backend->open()) return false;
+  running = true;
+
+  if (config != NULL) {
+    borderless_set_masks (config->mask, config->mask_ex);
+    borderless_set_mode (config->mode);
+  }
+
+  /* Without it, top-level checks fall back to enumeration */
+  inventory_start();
+  if (config != NULL && config->fullscreen) fullscreen_start();
+  return true;
+}
+
+BORDERLESS_API void borderless_shutdown (void)
+{
+  if (!running) return;
+  assert_ui_thread();
+  fullscreen_stop();
+  inventory_stop();
+
+  /* Forget tracked windows, leaving them as they are.
+  // The hook module must let go of them, though. */
+  for (size_t i = 0; i != border_store_size; ++i) {
+    hook_detach (border_store + i);
+    if (border_store[i].region != NULL) backend->free_region (border_store[i].region);
+  }
+  free (border_store);
+  border_store = NULL;
+  border_store_size = border_store_cap = region_count = 0;
+  region_pending = false;
+  location_watch();
+  free (menu_store);
+  menu_store = NULL;
+  menu_store_size = menu_store_cap = 0;
+
+  on_window = NULL;
+  backend->close();
+  running = false;
+}
+
+BORDERLESS_API void borderless_set_masks (LONG const mask, LONG const mask_ex)
+{
+  const bool defaults = mask == 0 && mask_ex == 0;
+  style_mask = defaults ? STYLE_MASK : mask;
+  style_ex_mask = defaults ? STYLE_EX_MASK : mask_ex;
+}
+
+BORDERLESS_API void borderless_set_mode (enum borderless_mode const mode)
+{
+  if ((int)mode >= 0 && (int)mode < BORDER_MODE_COUNT) border_mode = (enum border_mode)mode;
+}
+
+BORDERLESS_API bool borderless_set_fullscreen (bool const enable)
+{
+  assert_ui_thread();
+  if (enable) return fullscreen_start();
+  fullscreen_stop();
+  return true;
+}
+
+BORDERLESS_API bool borderless_compat_add (const wchar_t* const line)
+{
+  return compat_parse (line);
+}
+
+BORDERLESS_API void borderless_compat_clear (void)
+{
+  compat_user_size = 0;
+}
+
+BORDERLESS_API bool borderless_compat_get (size_t const index, wchar_t* const line
+, size_t const size)
+{
+  if (index >= compat_user_size || size == 0) return false;
+  wchar_t buf[COMPAT_LINE_MAX];
+  compat_format (buf, compat_user + index);
+  buf[numof(buf) - 1] = '\0';
+  wcsncpy (line, buf, size - 1);
+  line[size - 1] = '\0';
+  return true;
+}
+
+BORDERLESS_API bool borderless_border (HWND const wnd, enum borderless_action const action)
+{
+  const struct border_store_item* const r = border_find (wnd);
+  const bool automatic = r != NULL && r->automatic;
+  if (!border_set (wnd, action, NULL, true, NULL)) return false;
+  /* Otherwise its next move would hide them again */
+  if (automatic) fullscreen_decline (wnd);
+  return true;
+}
+
+BORDERLESS_API bool borderless_menu (HWND const wnd, enum borderless_action const action)
+{
+  return menu_set_own (wnd, action);
+}
+
+BORDERLESS_API size_t borderless_border_pid (DWORD const pid, enum borderless_action const action)
+{
+  return batch_process (pid, action, BORDERLESS_KEEP);
+}
+
+BORDERLESS_API size_t borderless_menu_pid (DWORD const pid, enum borderless_action const action)
+{
+  return batch_process (pid, BORDERLESS_KEEP, action);
+}
+
+BORDERLESS_API size_t borderless_batch (const struct borderless_op* const ops, size_t const num)
+{
+  return batch_apply (ops, num);
+}
+
+BORDERLESS_API bool borderless_get_place (HWND const wnd, enum borderless_place* const place
+, RECT* const rect)
+{
+  bool maximized;
+  if (!backend->get_placement (wnd, rect, &maximized)) return false;
+  place[0] = maximized ? BORDERLESS_PLACE_MAXIMIZED : BORDERLESS_PLACE_RECT;
+  return true;
+}
+
+BORDERLESS_API bool borderless_get_state (HWND const wnd, struct borderless_state* const state)
+{
+  assert_ui_thread();
+  const struct border_store_item* const r = border_find (wnd);
+  objzero (state);
+  if (r != NULL) {
+    state->border = true;
+    state->mode = (enum borderless_mode)r->mode;
+    state->mask = r->mask;
+    state->mask_ex = r->mask_ex;
+    state->automatic = r->automatic;
+  }
+  state->menu = menu_find (wnd) != NULL;
+  return state->border || state->menu;
+}
+
+BORDERLESS_API size_t borderless_windows (DWORD const pid, const wchar_t* const cls
+, bool const tracked, HWND* const out, size_t const max)
+{
+  assert_ui_thread();
+  const struct inventory_filter f = {.pid = pid, .cls = cls, .tracked = tracked};
+  return inventory_query (&f, out, max);
+}
+
+BORDERLESS_API bool borderless_window_exe (HWND const wnd, wchar_t* const path
+, size_t const size)
+{
+  assert_ui_thread();
+  struct window_info* const w = inventory_find (wnd);
+  const wchar_t* const exe = w != NULL ? inventory_exe (w) : NULL;
+  if (exe == NULL || wcslen (exe) >= size) return false;
+  wcscpy (path, exe);
+  return true;
+}
+
+BORDERLESS_API void borderless_on_window (borderless_window_fn* const fn, void* const param)
+{
+  on_window = fn;
+  on_window_param = param;
+}
@@ -0,0 +1,158 @@
+/* =============================================================================
+// BORDERless library
+//
+// Hide and restore window borders and/or menu bars from within
+// any application, e.g. a launcher stripping frames of the windows
+// it spawns. The resident BORDERless app is built on top of it.
+//
+// All functions must be called on the thread which called
+// `borderless_init()`. That thread must run a message loop:
+// window events and timers are delivered through it.
+//
+// Link with the static library, or define `BORDERLESS_DLL`
+// to use `libborderless.dll` instead.
+// -------------------------------------------------------------------------- */
+
+#ifndef LIBBORDERLESS_H
+#define LIBBORDERLESS_H
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include "wintypes.h"
+#endif
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(BORDERLESS_EXPORTS)
+#define BORDERLESS_API __declspec(dllexport)
+#elif defined(BORDERLESS_DLL)
+#define BORDERLESS_API __declspec(dllimport)
+#else
+#define BORDERLESS_API
+#endif
+
+/* Bumped whenever the API changes incompatibly */
+#define BORDERLESS_API_VERSION 1
+
+/* Compatibility rules, see `borderless_compat_add()` */
+#define BORDERLESS_COMPAT_MAX 32
+#define BORDERLESS_COMPAT_LINE_MAX 320
+
+enum borderless_action {
+  BORDERLESS_KEEP,    // leave as it is
+  BORDERLESS_HIDE,
+  BORDERLESS_RESTORE,
+  BORDERLESS_TOGGLE
+};
+
+/* How borders are hidden. See README for what each one does. */
+enum borderless_mode {
+  BORDERLESS_MODE_MASK,   // strip frame styles
+  BORDERLESS_MODE_DWM,    // ask DWM not to draw the border (Windows 11)
+  BORDERLESS_MODE_REGION  // clip the window to its client area
+};
+
+struct borderless_config {
+  DWORD size;   // `sizeof(struct borderless_config)`
+  /* Style masks for windows without a compatibility rule.
+  // Both zero for the built-in defaults. */
+  LONG mask;
+  LONG mask_ex;
+  enum borderless_mode mode;
+  bool fullscreen; // see `borderless_set_fullscreen()`
+};
+
+/* Platform layer, see `backend.h`: Windows by default, none
+// elsewhere. Can't be changed while running. */
+struct backend;
+BORDERLESS_API bool borderless_set_backend (const struct backend* impl);
+
+/* Starts tracking windows. `config` may be NULL for defaults. */
+BORDERLESS_API bool borderless_init (const struct borderless_config* config);
+/* Stops tracking. Windows are left the way they are. */
+BORDERLESS_API void borderless_shutdown (void);
+
+/* Settings, effective for borders hidden from now on */
+BORDERLESS_API void borderless_set_masks (LONG mask, LONG mask_ex);
+BORDERLESS_API void borderless_set_mode (enum borderless_mode mode);
+/* Hide borders of windows as soon as they cover a whole monitor
+// and restore them once they don't */
+BORDERLESS_API bool borderless_set_fullscreen (bool enable);
+
+/* Per window class rule: `<class> <mask> <ex mask> [<repaint>] [menu] [veto]`.
+// Takes precedence over built-in rules. */
+BORDERLESS_API bool borderless_compat_add (const wchar_t* line);
+/* Forgets all rules added so far */
+BORDERLESS_API void borderless_compat_clear (void);
+/* Rules added so far, in the same format. False past the last one. */
+BORDERLESS_API bool borderless_compat_get (size_t index, wchar_t* line, size_t size);
+
+/* Single top-level window. False if nothing changed. */
+BORDERLESS_API bool borderless_border (HWND wnd, enum borderless_action action);
+BORDERLESS_API bool borderless_menu (HWND wnd, enum borderless_action action);
+/* Every visible top-level window of a process, in one batch.
+// Returns how many windows changed. */
+BORDERLESS_API size_t borderless_border_pid (DWORD pid, enum borderless_action action);
+BORDERLESS_API size_t borderless_menu_pid (DWORD pid, enum borderless_action action);
+
+enum borderless_place {
+  BORDERLESS_PLACE_NONE,
+  BORDERLESS_PLACE_RECT,     // move and size to `rect`, in screen coordinates
+  BORDERLESS_PLACE_MAXIMIZED // restoring to `rect`, or to where it was if empty
+};
+
+struct borderless_op {
+  HWND wnd;
+  enum borderless_action border;
+  enum borderless_action menu;
+  /* Hiding only: both masks zero to use the rule for the window,
+  // mode -1 to use the one set with `borderless_set_mode()` */
+  LONG mask;
+  LONG mask_ex;
+  int mode;
+  enum borderless_place place;
+  RECT rect;
+};
+
+/* Applies all operations, then recomputes frames and moves windows
+// in one go, so the desktop recomposes once. Returns how many
+// windows changed. */
+BORDERLESS_API size_t borderless_batch (const struct borderless_op* ops, size_t num);
+/* Placement to put in an operation to bring the window back where
+// it is: maximized windows come with the rectangle they restore to */
+BORDERLESS_API bool borderless_get_place (HWND wnd, enum borderless_place* place, RECT* rect);
+
+struct borderless_state {
+  bool border;    // hidden
+  enum borderless_mode mode;
+  LONG mask;      // mask mode: styles removed
+  LONG mask_ex;
+  bool menu;      // hidden
+  bool automatic; // hidden because the window went fullscreen
+};
+
+/* False if neither border nor menu of the window is hidden */
+BORDERLESS_API bool borderless_get_state (HWND wnd, struct borderless_state* state);
+
+/* Top-level windows of a process (0 for any) and class (NULL for any),
+// optionally only those with hidden border or menu. Fills `out` with
+// up to `max` of them and returns how many matched in total. */
+BORDERLESS_API size_t borderless_windows (DWORD pid, const wchar_t* cls, bool tracked
+, HWND* out, size_t max);
+/* Full executable path of the window's process */
+BORDERLESS_API bool borderless_window_exe (HWND wnd, wchar_t* path, size_t size);
+
+/* Called whenever a top-level window appears on screen */
+typedef void borderless_window_fn (HWND wnd, DWORD pid, void* param);
+BORDERLESS_API void borderless_on_window (borderless_window_fn* fn, void* param);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,128 @@
+/* =============================================================================
+// BORDERless: just enough of WinAPI to build the core without Windows
+//
+// Private: `libborderless.h` includes it instead of <windows.h> on other
+// systems, so that the core logic and the configuration file code can be
+// built against the fake backend, see `bench/fake.c`. Nothing here
+// calls the operating system.
+// -------------------------------------------------------------------------- */
+
+#ifndef BORDERLESS_WINTYPES_H
+#define BORDERLESS_WINTYPES_H
+
+#include <stdint.h>
+#include <wchar.h>
+
+/* -----------------------------------------------------------------------------
+// Types */
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef int32_t LONG;
+typedef int64_t LONG64;
+typedef uint32_t DWORD;
+typedef unsigned int UINT;
+typedef uintptr_t ULONG_PTR;
+
+typedef struct HWND__* HWND;
+typedef struct HMENU__* HMENU;
+typedef struct HDWP__* HDWP;
+
+typedef struct tagRECT {
+  LONG left;
+  LONG top;
+  LONG right;
+  LONG bottom;
+} RECT;
+
+#define TRUE 1
+#define FALSE 0
+#define MAX_PATH 260
+
+/* -----------------------------------------------------------------------------
+// Window styles */
+#define WS_OVERLAPPED   0x00000000L
+#define WS_POPUP        ((LONG)0x80000000u)
+#define WS_CHILD        0x40000000L
+#define WS_VISIBLE      0x10000000L
+#define WS_CAPTION      0x00c00000L
+#define WS_BORDER       0x00800000L
+#define WS_DLGFRAME     0x00400000L
+#define WS_SYSMENU      0x00080000L
+#define WS_THICKFRAME   0x00040000L
+#define WS_MINIMIZEBOX  0x00020000L
+#define WS_MAXIMIZEBOX  0x00010000L
+#define WS_OVERLAPPEDWINDOW (WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU\
+| WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX)
+
+#define WS_EX_DLGMODALFRAME 0x00000001L
+#define WS_EX_TOOLWINDOW    0x00000080L
+#define WS_EX_WINDOWEDGE    0x00000100L
+#define WS_EX_CLIENTEDGE    0x00000200L
+#define WS_EX_STATICEDGE    0x00020000L
+
+#define GWL_STYLE   (-16)
+#define GWL_EXSTYLE (-20)
+
+/* -----------------------------------------------------------------------------
+// Placement */
+#define SWP_NOSIZE        0x0001
+#define SWP_NOMOVE        0x0002
+#define SWP_NOZORDER      0x0004
+#define SWP_NOACTIVATE    0x0010
+#define SWP_FRAMECHANGED  0x0020
+#define SWP_NOOWNERZORDER 0x0200
+
+#define SW_SHOWNORMAL      1
+#define SW_SHOWMINIMIZED   2
+#define SW_SHOWMAXIMIZED   3
+#define SW_SHOWNOACTIVATE  4
+#define SW_SHOWMINNOACTIVE 7
+#define SW_RESTORE         9
+
+/* -----------------------------------------------------------------------------
+// Hotkeys */
+#define MOD_ALT      0x0001
+#define MOD_CONTROL  0x0002
+#define MOD_SHIFT    0x0004
+#define MOD_WIN      0x0008
+#define MOD_NOREPEAT 0x4000
+
+#define VK_BACK      0x08
+#define VK_TAB       0x09
+#define VK_PRIOR     0x21
+#define VK_NEXT      0x22
+#define VK_END       0x23
+#define VK_HOME      0x24
+#define VK_LEFT      0x25
+#define VK_UP        0x26
+#define VK_RIGHT     0x27
+#define VK_DOWN      0x28
+#define VK_INSERT    0x2d
+#define VK_DELETE    0x2e
+#define VK_NUMPAD0   0x60
+#define VK_MULTIPLY  0x6a
+#define VK_ADD       0x6b
+#define VK_SUBTRACT  0x6d
+#define VK_DECIMAL   0x6e
+#define VK_DIVIDE    0x6f
+#define VK_F1        0x70
+#define VK_OEM_1     0xba
+#define VK_OEM_PLUS  0xbb
+#define VK_OEM_COMMA 0xbc
+#define VK_OEM_MINUS 0xbd
+#define VK_OEM_PERIOD 0xbe
+#define VK_OEM_2     0xbf
+#define VK_OEM_3     0xc0
+#define VK_OEM_4     0xdb
+#define VK_OEM_5     0xdc
+#define VK_OEM_6     0xdd
+#define VK_OEM_7     0xde
+
+/* -----------------------------------------------------------------------------
+// C runtime */
+#define _wcsicmp wcscasecmp
+#define _wcsnicmp wcsncasecmp
+#define _wcsdup wcsdup
+#define _snwprintf swprintf
+
+#endif